@@ -0,0 +1,187 @@
+// talawachess_bench: microbenchmarks of the core primitives over the bench positions.
+// Every benchmark is warmed up, then timed over several repetitions; the spread between
+// repetitions tells whether a difference between two builds is real.
+//
+// Usage: talawachess_bench [--reps N] [--min-ms N] [--filter NAME] [--json]
+#include "Bench.hpp"
+#include "Board.hpp"
+#include "Evaluator.hpp"
+#include "MoveGenerator.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace talawachess;
+using namespace talawachess::core;
+using namespace talawachess::core::board;
+
+// Results feed into this, so the compiler cannot drop the work being measured
+static volatile uint64_t sink= 0;
+
+struct Position {
+    std::string fen;
+    Board board;
+    MoveList moves; // Pseudo-legal moves
+};
+
+struct Benchmark {
+    std::string name;
+    // Runs one pass over the corpus and returns the number of operations it did
+    std::function<uint64_t(std::vector<Position>&)> pass;
+};
+
+struct Result {
+    std::string name;
+    uint64_t opsPerRep= 0;
+    double minNs= 0, medianNs= 0, meanNs= 0, stddevNs= 0; // Per operation
+};
+
+static double elapsedNs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+static Result measure(const Benchmark& benchmark, std::vector<Position>& corpus, int reps, double minRepNs) {
+    // Warmup, which also sizes a repetition: enough passes to last minRepNs
+    uint64_t opsPerPass= benchmark.pass(corpus);
+    int passes= 1;
+    while(true) {
+        auto start= std::chrono::steady_clock::now();
+        for(int i= 0; i < passes; ++i) benchmark.pass(corpus);
+        if(elapsedNs(start) >= minRepNs) break;
+        passes*= 2;
+    }
+
+    std::vector<double> samples;
+    for(int rep= 0; rep < reps; ++rep) {
+        auto start= std::chrono::steady_clock::now();
+        for(int i= 0; i < passes; ++i) benchmark.pass(corpus);
+        samples.push_back(elapsedNs(start) / (static_cast<double>(opsPerPass) * passes));
+    }
+    std::sort(samples.begin(), samples.end());
+
+    Result result;
+    result.name= benchmark.name;
+    result.opsPerRep= opsPerPass * passes;
+    result.minNs= samples.front();
+    result.medianNs= samples.size() % 2 ? samples[samples.size() / 2] : (samples[samples.size() / 2 - 1] + samples[samples.size() / 2]) / 2;
+    for(double sample: samples) result.meanNs+= sample / samples.size();
+    for(double sample: samples) result.stddevNs+= (sample - result.meanNs) * (sample - result.meanNs) / samples.size();
+    result.stddevNs= std::sqrt(result.stddevNs);
+    return result;
+}
+
+static std::vector<Benchmark> benchmarks() {
+    return {
+        {"makemove+undomove", [](std::vector<Position>& corpus) {
+             uint64_t ops= 0;
+             for(auto& position: corpus) {
+                 for(const auto& move: position.moves) {
+                     position.board.makeMove(move);
+                     sink= sink + position.board.zobristHash;
+                     position.board.undoMove();
+                 }
+                 ops+= position.moves.count;
+             }
+             return ops;
+         }},
+        {"generateMoves", [](std::vector<Position>& corpus) {
+             MoveList moves;
+             for(auto& position: corpus) {
+                 MoveGenerator generator(position.board);
+                 moves.clear();
+                 generator.generateMoves(moves);
+                 sink= sink + moves.count;
+             }
+             return static_cast<uint64_t>(corpus.size());
+         }},
+        {"isSquareAttacked", [](std::vector<Position>& corpus) {
+             uint64_t attacked= 0;
+             for(const auto& position: corpus) {
+                 for(int square= 0; square < 64; ++square) {
+                     attacked+= MoveGenerator::isSquareAttacked(position.board, Coordinate::FromIndex(square), Piece::WHITE);
+                     attacked+= MoveGenerator::isSquareAttacked(position.board, Coordinate::FromIndex(square), Piece::BLACK);
+                 }
+             }
+             sink= sink + attacked;
+             return static_cast<uint64_t>(corpus.size() * 128);
+         }},
+        {"evaluate", [](std::vector<Position>& corpus) {
+             for(const auto& position: corpus) sink= sink + bot::evaluator::evaluate(position.board);
+             return static_cast<uint64_t>(corpus.size());
+         }},
+        {"setFen", [](std::vector<Position>& corpus) {
+             Board board;
+             for(const auto& position: corpus) {
+                 board.setFen(position.fen);
+                 sink= sink + board.zobristHash;
+             }
+             return static_cast<uint64_t>(corpus.size());
+         }},
+        {"calculateHash", [](std::vector<Position>& corpus) {
+             for(const auto& position: corpus) sink= sink + position.board.calculateHash();
+             return static_cast<uint64_t>(corpus.size());
+         }},
+    };
+}
+
+int main(int argc, char* argv[]) {
+    int reps= 15;
+    double minRepMs= 20.0;
+    std::string filter;
+    bool json= false;
+    for(int i= 1; i < argc; ++i) {
+        std::string arg= argv[i];
+        bool hasValue= i + 1 < argc;
+        if(arg == "--reps" && hasValue) reps= std::max(1, std::stoi(argv[++i]));
+        else if(arg == "--min-ms" && hasValue) minRepMs= std::stod(argv[++i]);
+        else if(arg == "--filter" && hasValue) filter= argv[++i];
+        else if(arg == "--json") json= true;
+        else {
+            std::cerr << "usage: talawachess_bench [--reps N] [--min-ms N] [--filter NAME] [--json]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<Position> corpus(BENCH_POSITION_COUNT);
+    for(int i= 0; i < BENCH_POSITION_COUNT; ++i) {
+        corpus[i].fen= BENCH_POSITIONS[i];
+        corpus[i].board.setFen(corpus[i].fen);
+        MoveGenerator generator(corpus[i].board);
+        generator.generateMoves(corpus[i].moves);
+    }
+
+    std::vector<Result> results;
+    if(!json) {
+        std::cout << std::left << std::setw(20) << "benchmark" << std::right << std::setw(12) << "ops/rep" << std::setw(10) << "min"
+                  << std::setw(10) << "median" << std::setw(10) << "mean" << std::setw(10) << "stddev" << "  (ns/op, " << reps
+                  << " reps)" << std::endl;
+    }
+    for(const auto& benchmark: benchmarks()) {
+        if(!filter.empty() && benchmark.name.find(filter) == std::string::npos) continue;
+        Result result= measure(benchmark, corpus, reps, minRepMs * 1e6);
+        results.push_back(result);
+        if(!json) {
+            std::cout << std::left << std::setw(20) << result.name << std::right << std::setw(12) << result.opsPerRep << std::fixed
+                      << std::setprecision(2) << std::setw(10) << result.minNs << std::setw(10) << result.medianNs << std::setw(10)
+                      << result.meanNs << std::setw(10) << result.stddevNs << std::endl;
+        }
+    }
+
+    if(json) {
+        std::cout << "[";
+        for(size_t i= 0; i < results.size(); ++i) {
+            const Result& r= results[i];
+            std::cout << (i ? ",\n " : "") << "{\"name\":\"" << r.name << "\",\"reps\":" << reps << ",\"opsPerRep\":" << r.opsPerRep
+                      << std::fixed << std::setprecision(3) << ",\"minNs\":" << r.minNs << ",\"medianNs\":" << r.medianNs
+                      << ",\"meanNs\":" << r.meanNs << ",\"stddevNs\":" << r.stddevNs << "}";
+        }
+        std::cout << "]" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Bot.hpp"
+#include "Json.hpp"
+#include "TimeManager.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace talawachess {
+
+struct ServerOptions {
+    std::string socketPath; // Unix domain socket to listen on; empty to use TCP
+    int port= 0;            // TCP port on 127.0.0.1 when no socket path is given
+    int workers= 0;         // Search workers, 0 for one per hardware thread
+    size_t hashMB= 64;      // TT size per worker, or in total with sharedHash
+    bool sharedHash= false; // One TT for all workers instead of one each
+};
+
+// Long-running analysis service. Clients connect over a local socket and send one JSON object
+// per line; every job is queued and picked up by a fixed pool of workers, each with its own
+// Bot. Results are streamed back on the job's connection as JSON lines.
+//
+// Requests:  {"id":1,"fen":"startpos","moves":"e2e4 e7e5","depth":12,"multipv":3}
+//            (limits: depth, movetime, wtime, btime, winc, binc, movestogo, infinite)
+//            {"cmd":"stop","id":1}     stops a queued or running job
+//            {"cmd":"shutdown"}        stops everything and makes run() return
+// Responses: {"id":1,"type":"info","depth":..,"multipv":..,"score":{"cp":..},...,"pv":"..."}
+//            {"id":1,"type":"bestmove","bestmove":"e2e4","ponder":"e7e5"}
+//            {"id":1,"type":"error","message":"..."}
+class AnalysisServer {
+  public:
+    explicit AnalysisServer(const ServerOptions& options);
+    ~AnalysisServer();
+
+    // Listens and serves until a shutdown request; returns the process exit code
+    int run();
+
+  private:
+    struct Connection {
+        int fd= -1;
+        std::mutex writeMutex;
+        std::atomic<bool> closed= false;     // Peer gone: drop its output, stop its jobs
+        std::atomic<bool> readerDone= false; // Its reader thread can be joined
+        bool send(const std::string& line); // Appends the newline; false once the peer is gone
+    };
+
+    struct Job {
+        std::shared_ptr<Connection> connection;
+        json::Value id;
+        std::string fen;
+        std::vector<std::string> moves;
+        SearchLimits limits;
+        int multiPV= 1;
+    };
+
+    struct Worker {
+        std::unique_ptr<Bot> bot;
+        std::thread thread;
+        const Job* running= nullptr; // Guarded by _jobsMutex
+    };
+
+    ServerOptions _options;
+    int _listenFd= -1;
+    std::atomic<bool> _shutdown= false;
+
+    std::deque<Job> _jobs;
+    std::mutex _jobsMutex;
+    std::condition_variable _jobsAvailable;
+    std::vector<Worker> _workers;
+
+    std::vector<std::pair<std::shared_ptr<Connection>, std::thread>> _connections; // With their reader threads
+
+    bool openListener(std::string& error);
+    void serveConnection(std::shared_ptr<Connection> connection);
+    void handleRequest(const std::shared_ptr<Connection>& connection, const std::string& line);
+    bool parseJob(const json::Object& request, Job& job, std::string& error);
+    void stopJobs(const Connection* connection, const json::Value* id);
+    void workerLoop(Worker& worker);
+    void runJob(Bot& bot, const Job& job);
+    void shutdown();
+};
+
+} // namespace talawachess
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Move.hpp"
+#include "Pgn.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace talawachess {
+
+struct AnnotateOptions {
+    std::string inputPath;
+    std::string outputPath= "annotated.pgn";
+    uint64_t nodes= 200000; // Search budget per position
+    int threads= 0;         // 0 for one per hardware thread
+    int mistakeCp= 100;     // Score loss marked "?" ($2)
+    int blunderCp= 200;     // Score loss marked "??" ($4)
+    size_t hashMB= 16;      // TT size per thread
+};
+
+// Searches every position of every game in a PGN file, spread over all cores position by
+// position, and writes the games back with [%eval] comments and mistake/blunder NAGs.
+class Annotator {
+  public:
+    explicit Annotator(const AnnotateOptions& options);
+
+    // Returns the process exit code
+    int run();
+
+  private:
+    struct PositionEval {
+        int score= 0; // Side to move's point of view, mate scores clamped
+        bool isMate= false;
+        int mateIn= 0;
+        bool terminal= false; // No legal moves: nothing was searched
+        core::Move bestMove;
+    };
+
+    struct AnnotatedGame {
+        pgn::Game game;
+        std::string fen;
+        std::vector<core::Move> moves;
+        std::vector<PositionEval> evals; // One per position: moves.size() + 1
+    };
+
+    AnnotateOptions _options;
+    std::vector<AnnotatedGame> _games;
+
+    void writeGame(std::ostream& out, const AnnotatedGame& game, int& mistakes, int& blunders) const;
+};
+
+} // namespace talawachess
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace talawachess {
+
+struct BenchOptions {
+    int depth= 7; // A few seconds on one thread
+    int threads= 1;
+    size_t hashMB= 16;
+};
+
+struct BenchResult {
+    uint64_t nodes= 0; // The signature: any functional change to the search changes it
+    int timeMs= 0;
+};
+
+// The fixed position set of bench: openings, middlegames, endgames, mates and stalemates.
+// Also the corpus of the talawachess_bench microbenchmarks.
+extern const char* const BENCH_POSITIONS[];
+extern const int BENCH_POSITION_COUNT;
+
+// Searches a fixed set of positions to a fixed depth, each from an empty TT and fresh
+// histories, and prints per-position and total node counts, time and NPS. With one thread
+// the node total is deterministic; with more, Lazy SMP makes it vary from run to run.
+BenchResult runBench(const BenchOptions& options);
+
+// The bench positions with the profiling zones reset first and their breakdown printed after.
+// Only does something in instrumented builds (TALAWA_PROFILE).
+void runProfile(const BenchOptions& options);
+
+} // namespace talawachess
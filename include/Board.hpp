@@ -66,8 +66,10 @@ class Board {
     void undoNullMove();
 
     // Zobrist Helpers
-    // Initializes the random keys (called once by constructor)
+    // Initializes the random keys (called once, by the first constructor)
     static void initZobrist();
+    // Identifies the key set, so hashes stored elsewhere (e.g. TT files) can be checked against it
+    static uint64_t zobristFingerprint();
     // Calculates the hash from scratch (slow, used for verification/initialization)
     uint64_t calculateHash() const;
 };
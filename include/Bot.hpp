@@ -2,26 +2,95 @@
 
 #include "Board.hpp"
 #include "MoveGenerator.hpp"
+#include "SearchStats.hpp"
+#include "SearchTrace.hpp"
+#include "SearchTelemetry.hpp"
+#include "TimeManager.hpp"
+#include "TranspositionTable.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <random>
+#include <thread>
 #include <utility>
 
 namespace talawachess {
 
-// Transposition Table Flags
-enum TTFlag : uint8_t {
-    TT_EXACT, // We know the exact score
-    TT_ALPHA, // Upper Bound (We know the score is at most this)
-    TT_BETA   // Lower Bound (We know the score is at least this)
+// Maximum search depth in plies (size of the per-ply search stack)
+static constexpr int MAX_PLY= 64;
+
+// Continuation history slice: bonus for playing [piece][to] after a given earlier move
+using PieceToHistory= std::array<std::array<int16_t, 64>, 12>;
+
+// Per-ply search state. Each searching thread owns one array indexed by ply, so
+// trend information (static eval two plies ago, the moves leading here) is free to read.
+struct SearchStack {
+    int staticEval= 0;
+    bool inCheck= false;
+    bool improving= false;          // Static eval is better than two plies ago
+    core::Move currentMove;         // Move being searched from this ply
+    core::Move excludedMove;        // Move skipped by a singular extension verification search
+    core::Move killers[2];          // Quiet moves that caused cutoffs at this ply
+    PieceToHistory* continuationHistory= nullptr; // History slice selected by currentMove
+    core::Move pv[MAX_PLY];         // Principal variation from this ply (triangular PV table row)
+    int pvLength= 0;
+#ifdef TALAWA_TRACE
+    int8_t traceReduction= 0; // Reduction and extension of the child being searched, for its record
+    int8_t traceExtension= 0;
+#endif
 };
 
-struct TTEntry {
-    uint64_t zobristHash;
-    core::Move bestMove;
+// Root move with statistics that persist across iterative-deepening iterations
+struct RootMove {
+    core::Move move;
     int score;
-    int depth;
-    TTFlag flag;
+    int previousScore;      // Score from the previous completed iteration
+    uint64_t nodes= 0;      // Nodes spent in this move's subtree, summed over all iterations
+    std::vector<core::Move> pv;
+
+    RootMove(const core::Move& m, int initialScore): move(m), score(initialScore), previousScore(initialScore), pv{m} {}
+};
+
+// One line of search output, what a UCI "info" line carries
+struct SearchInfo {
+    int depth= 0;
+    int multiPV= 1;     // 1-based rank of this line
+    int score= 0;       // Centipawns, unless isMate
+    bool isMate= false;
+    int mateIn= 0;      // Moves to mate, negative when the side to move gets mated
+    int timeMs= 0;
+    uint64_t nodes= 0;
+    uint64_t nps= 0;
+    int hashfull= 0; // Per mille
+    std::vector<core::Move> pv;
+};
+using InfoCallback= std::function<void(const SearchInfo&)>;
+
+// "info depth ... pv ..." without the trailing newline
+std::string toUciInfo(const SearchInfo& info);
+
+// Pruning and reduction constants of the search. Defaults are the tuned values;
+// self-play matches set them per engine to measure a change.
+struct SearchParams {
+    int rfpMargin= 120;     // Reverse futility margin per ply of depth
+    int rfpMaxDepth= 6;     // Deepest node reverse futility pruning applies to
+    int deltaMargin= 200;   // Safety margin for quiescence delta pruning (centipawns)
+    int nullMoveBase= 2;    // Null move reduction: base + depth / divisor
+    int nullMoveDivisor= 6;
+    int lmrMinMove= 3;      // Moves searched at full depth before late move reduction starts
+    int lmrDepthDivisor= 4; // Reduction: 1 + depth / depthDivisor + moveIndex / moveDivisor
+    int lmrMoveDivisor= 8;
+    int singularMinDepth= 8;
+
+    // Sets one parameter by name, e.g. set("rfpMargin", 100). False for unknown names.
+    bool set(const std::string& name, int value);
+    // "name=value,name=value"; false (and error set) on the first bad entry
+    bool parse(const std::string& text, std::string& error);
+    std::string toString() const;
 };
 
 class Bot {
@@ -29,42 +98,99 @@ class Bot {
     core::board::Board _board;
     core::board::MoveGenerator _moveGen;
 
-    std::vector<TTEntry> _tt;
-    void resizeTT(size_t sizeInMB);
-    void clearTT();
+    std::shared_ptr<TranspositionTable> _tt; // Shared with the helper threads
+    // TT access for the current position. The table keeps 16-bit scores, so mate scores
+    // travel as their distance from +-TT_MATE.
+    static const int TT_MATE= 32000;
+    bool ttProbe(TTData& data) const;
+    void ttStore(const core::Move& bestMove, int score, int depth, TTFlag flag);
+
+    // Lazy SMP: helper searchers with their own board, stack and histories, sharing the TT
+    std::vector<std::unique_ptr<Bot>> _helpers;
+    std::vector<std::thread> _helperThreads;
+    int _completedDepth= 0;                         // Last fully searched depth
+    RootMove _completedBest= RootMove(core::Move(), 0); // Best root move of that depth
+    void startHelpers(int depthLimit);
+    void stopHelpers();
+    void helperSearch(int depthLimit, int threadIndex);
+    const Bot* voteBestThread() const;
 
-    // Killer Moves: 2 killers per ply, max 64 plies
-    static const int MAX_PLY= 64;
-    core::Move _killers[MAX_PLY][2];
-    void clearKillers();
+    // Search Stack: one entry per ply, max MAX_PLY plies. STACK_OFFSET sentinel entries
+    // below ply 0 let every node look back two plies without bounds checks.
+    static const int STACK_OFFSET= 2;
+    SearchStack _stack[MAX_PLY + STACK_OFFSET + 1];
+    SearchStack& stackAt(int ply) { return _stack[ply + STACK_OFFSET]; }
+    void clearStack();
     void updateKillers(const core::Move& move, int ply);
 
+    // History Heuristics for quiet moves
+    static const int HISTORY_MAX= 16384;
+    int16_t _history[2][64][64];                          // [side][from][to]
+    std::vector<PieceToHistory> _continuationHistory;     // [piece * 64 + to] of the previous move
+    void clearHistory();
+    void updateQuietStats(const core::Move& move, int ply, int depth, const core::Move* quietsTried, int quietCount);
+    int quietHistoryScore(const core::Move& move, int ply) const;
+
     // Infinity constant for search
     static const int INF= 1000000000;
     static const int MATE_VAL= 9000000;
 
-    int positionsEvaluated= 0; // For performance metrics
-    int checkMatesFound= 0;    // For performance metrics
+    SearchParams _params;
+    bool _qsearchChecks= true; // Search quiet checking moves at the first quiescence ply
+
+    // Root moves of the current search, re-sorted after every iteration
+    std::vector<RootMove> _rootMoves;
+    void initRootMoves();
+
+    std::atomic<uint64_t> _nodes= 0; // Nodes visited (main search + quiescence), read by the main thread
+    // Only this thread writes _nodes: a plain load/store avoids a locked increment
+    void countNode() { _nodes.store(_nodes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+    SearchStats _stats;                    // This thread's counters
+    std::vector<uint64_t> _iterationNodes; // Nodes (all threads) at the end of each completed depth
 
     // Time Management
     std::chrono::time_point<std::chrono::steady_clock> _searchStartTime;
-    int _timeLimitMs= 0;
-    bool _stopSearch= false;
+    std::chrono::time_point<std::chrono::steady_clock> _clockStartTime; // When our clock started: go, or ponderhit
+    TimeManager _timeManager;
+    int _timeLimitMs= 0;       // Hard limit of the current search, 0 for none
+    int _moveOverheadMs= 30;   // Reserved per move for GUI/network latency
+    uint64_t _nodeLimit= 0;    // "go nodes" over all threads, 0 for none
+    std::atomic<bool> _stopSearch= false; // Set by the UCI thread ("stop") or by checkTime
+
+    // Pondering: no time limits apply until the UCI thread reports a ponderhit
+    std::atomic<bool> _pondering= false;
+    std::atomic<bool> _ponderhitPending= false;
+    core::Move _ponderMove; // Expected reply to the last best move
+
+    SearchTelemetry _telemetry; // Stop latency and time overshoot, per game
 
-    // Optional callback to check for stop command from UCI
-    std::function<bool()> _inputChecker= nullptr;
+#ifdef TALAWA_TRACE
+    std::unique_ptr<trace::Recorder> _trace; // Null unless a TraceFile is set
+    trace::Reason _traceReason= trace::SEARCHED; // Why the last searchNode returned
+    int _traceIteration= 0;
+#endif
+
+    InfoCallback _infoCallback; // Empty: print UCI info lines
+    int _multiPV= 1;            // Number of root moves reported with exact scores
 
     void checkTime() {
         if(_stopSearch) return; // Already signaled to stop
-        // Check for external stop command via input polling
-        if(_inputChecker && _inputChecker()) {
+        if(_nodeLimit > 0 && totalNodes() >= _nodeLimit) { // Helpers included, like info nodes
             _stopSearch= true;
             return;
         }
+        auto now= std::chrono::steady_clock::now();
+        _telemetry.timeChecked(now);
+        if(_ponderhitPending.exchange(false)) {
+            _clockStartTime= now; // Our clock starts running now
+            _telemetry.clockStarted(now, _timeLimitMs);
+        }
+        if(_pondering) return;        // Thinking on the opponent's time
         if(_timeLimitMs <= 0) return; // No time limit (infinite or depth-only search)
-        int elapsedMs= getElapsedTimeMs();
+        int elapsedMs= getClockElapsedMs();
         if(elapsedMs >= _timeLimitMs) {
             _stopSearch= true;
+            _telemetry.deadlineHit();
         }
     }
 
@@ -73,29 +199,126 @@ class Bot {
         return std::chrono::duration_cast<std::chrono::milliseconds>(now - _searchStartTime).count();
     }
 
+    int getClockElapsedMs() const {
+        auto now= std::chrono::steady_clock::now();
+        return std::chrono::duration_cast<std::chrono::milliseconds>(now - _clockStartTime).count();
+    }
+
     void startTimer(int timeLimitMs= 0) {
         _searchStartTime= std::chrono::steady_clock::now();
+        _clockStartTime= _searchStartTime;
         _timeLimitMs= timeLimitMs;
-        _stopSearch= false;
     }
 
   public:
+    static const size_t DEFAULT_HASH_MB= 512;
+
     Bot();
+    explicit Bot(std::shared_ptr<TranspositionTable> tt);
+    ~Bot();
 
     void setFen(const std::string& fen);
+    // Search from a copy of board, move history included (for repetition detection)
+    void setPosition(const core::board::Board& board) { _board= board; }
     void performMove(const std::string& moveStr);
-    std::pair<core::Move, int> getBestMove(int timeLimitMs, int maxDepth= 0);
-    void stopSearch() { _stopSearch= true; }
-    void setInputChecker(std::function<bool()> checker) { _inputChecker= checker; }
+    std::pair<core::Move, int> getBestMove(const SearchLimits& limits);
+    void setMoveOverhead(int ms) { _moveOverheadMs= ms; }
+    int getMoveOverhead() const { return _moveOverheadMs; }
+    // Total search threads including this one; only call while no search is running
+    void setThreads(int threads);
+    // Search output goes to the callback instead of stdout; it runs on the search thread
+    void setInfoCallback(InfoCallback callback) { _infoCallback= std::move(callback); }
+    void setMultiPV(int lines) { _multiPV= std::max(1, lines); }
+    // Applies to the helper threads too; only call while no search is running
+    void setSearchParams(const SearchParams& params);
+    const SearchParams& getSearchParams() const { return _params; }
+    // Forget move-ordering statistics (histories, killers) learned in earlier searches
+    void resetHeuristics() {
+        clearHistory();
+        clearStack();
+    }
+    // Resize the TT, which also empties it. A shared table keeps its size: returns false with
+    // the reason in error. Only call while no search is running.
+    bool setHashSize(size_t sizeInMB, std::string& error);
+    size_t getHashSize() const { return _tt->sizeInMB(); }
+    // Empty the TT for a new game or position set, zeroing it with as many threads as the
+    // search uses. A shared or file-backed table is kept: its entries are meant to outlive
+    // games (see clearSharedHash). Only call while no search is running.
+    void clearHash() {
+        if(!_tt->isShared()) _tt->clear(static_cast<int>(_helpers.size()) + 1);
+    }
+    // Empty the TT whatever backs it: the explicit "Clear Hash". A shared segment is only
+    // cleared by the process that created it; elsewhere returns false with the reason in
+    // error. Only call while no search is running.
+    bool clearSharedHash(std::string& error);
+    // Back a newly allocated TT with memory now (see TranspositionTable::prefault). Only call
+    // while no search is running.
+    void prefaultHash() { _tt->prefault(); }
+    // Attach the TT to a named shared-memory segment ("" for a private table again).
+    // Only call while no search is running. Returns false (table unchanged) on failure.
+    bool setSharedHash(const std::string& name, std::string& error);
+    // Back the TT with a file that keeps its entries across runs ("" for a private table again).
+    // Same contract as setSharedHash.
+    bool setHashFile(const std::string& path, std::string& error);
+    // TT snapshots (see TranspositionTable::save); only call while no search is running
+    bool saveHash(const std::string& path, std::string& error) const { return _tt->save(path, error); }
+    bool loadHash(const std::string& path, std::string& error) { return _tt->load(path, error); }
+    // Record the main thread's search tree to a file ("" to stop); the file is truncated.
+    // Fails unless built with TALAWA_TRACE. Only call while no search is running.
+    bool setTraceFile(const std::string& path, std::string& error);
+    const std::vector<RootMove>& getRootMoves() const { return _rootMoves; }
+    // Nodes of the last (or running) search, helper threads included
+    uint64_t totalNodes() const;
+    // Counters of the last search, summed over all threads; only call while no search is running
+    SearchReport getSearchReport() const;
+    // Safe to call from another thread. A stop requested before the search starts is honoured,
+    // so clear it before launching a new search; getBestMove clears it again when it returns.
+    void stopSearch() {
+        _telemetry.stopRequested();
+        _stopSearch= true;
+    }
+    void clearStop() {
+        _stopSearch= false;
+        _telemetry.clearStopRequest();
+    }
+    // Arms the ponder state of the next search ("go ponder"). Like clearStop, call it before
+    // launching the search, so a ponderhit that arrives before the search starts is kept.
+    void setPondering(bool pondering) {
+        _ponderhitPending= false;
+        _pondering= pondering;
+    }
+    // The opponent played the expected move: a running "go ponder" search becomes a timed search
+    void ponderhit() {
+        _ponderhitPending= true;
+        _pondering= false;
+    }
+    // Expected reply to the move returned by the last getBestMove (from its PV), may be empty
+    const core::Move& getPonderMove() const { return _ponderMove; }
+    // Not thread-safe except for stop requests: only touch it while no search is running,
+    // or from the search thread itself (endSearch right before bestmove)
+    SearchTelemetry& getTelemetry() { return _telemetry; }
     const core::board::Board& getBoard() const {
         return _board;
     }
 
   private:
-    int quiesce(int alpha, int beta, int ply);
-    int search(int depth, int ply, int alpha, int beta);
+    int quiesce(int alpha, int beta, int ply, int qsDepth= 0);
+#ifdef TALAWA_TRACE
+    int search(int depth, int ply, int alpha, int beta); // searchNode, then records the node
+#else
+    int search(int depth, int ply, int alpha, int beta) { return searchNode(depth, ply, alpha, beta); }
+#endif
+    int searchNode(int depth, int ply, int alpha, int beta);
     void orderMoves(core::board::MoveList& moves, const core::Move* ttMove, int ply) const;
-    std::string extractPV(const core::Move& bestMove, int depth);
+    int see(const core::Move& move) const;
+    bool isInCheck() const;
+    void updatePV(int ply, const core::Move& move);
+    void completePV(std::vector<core::Move>& pv, int depth);
+    int searchRoot(int depth);
+    void sortRootMoves();
+    void printInfo(int depth, int score, const std::vector<core::Move>& pv, int multiPV= 1);
+    void reportInfo(const SearchInfo& info);
+    void updatePonderMove(std::vector<core::Move> pv);
 };
 
 } // namespace talawachess
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Bot.hpp"
+#include "TrainingData.hpp"
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace talawachess {
+
+struct DataGenOptions {
+    std::string outputPath= "data.bin"; // Appended to, see TrainingData.hpp
+    uint64_t positions= 1000000;        // Positions to add in this run
+    int threads= 0;                     // One game per thread, 0 for one per hardware thread
+    int depth= 0;                       // Search limit per move: a depth, or else
+    uint64_t nodes= 5000;               // a node count
+    int randomPlies= 8;                 // Uniformly random moves opening every game
+    int maxOpeningScore= 400;           // Discard openings the search already sees as lost/won
+    int adjudicateScore= 2000;          // A win once both sides agree on this for 4 plies
+    int maxPlies= 400;                  // Draw when reached
+    size_t hashMB= 16;                  // TT size per thread
+    uint64_t seed= 0;                   // 0 for a random seed
+};
+
+// Plays randomized self-play games at a fixed node or depth limit on every thread and writes
+// the quiet positions with their search score and the final game result.
+class DataGenerator {
+  public:
+    explicit DataGenerator(const DataGenOptions& options);
+
+    // Returns the process exit code
+    int run();
+
+  private:
+    DataGenOptions _options;
+
+    // Appends one game's records (empty if the opening was rejected)
+    void playGame(Bot& bot, std::mt19937_64& rng, std::vector<data::PackedPosition>& records) const;
+};
+
+} // namespace talawachess
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Bot.hpp"
+#include "TimeManager.hpp"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Embedding API of the talawachess_core library (C callers: talawachess.h)
+namespace talawachess {
+
+struct EngineOptions {
+    size_t hashMB= 64; // Transposition table of this engine alone
+    int threads= 1;    // Search threads
+};
+
+struct SearchResult {
+    core::Move bestMove;   // from == to when the side to move has no legal move
+    core::Move ponderMove; // Expected reply, may be empty
+    int score= 0;          // Side to move's point of view: centipawns, or a huge value for a mate (see isMate)
+    bool isMate= false;
+    int mateIn= 0; // Moves to mate, negative when the side to move gets mated
+    int depth= 0;  // Last completed depth
+    uint64_t nodes= 0;
+    int timeMs= 0;
+};
+
+// One self-contained engine: its own board, search threads and transposition table, so any
+// number of them can search in one process at the same time. Calls on one engine are
+// serialized (a search started while another runs waits for it), except stop() and
+// ponderhit(), which may come from any thread while search() is running.
+class Engine {
+  public:
+    explicit Engine(const EngineOptions& options= EngineOptions());
+    ~Engine(); // Stops a running search and waits for it
+
+    Engine(const Engine&)= delete;
+    Engine& operator=(const Engine&)= delete;
+
+    // "startpos" or a FEN, then moves in UCI notation ("e2e4", "e7e8q"). Returns false with the
+    // reason in error, and leaves the position unchanged, on a bad FEN or an illegal move.
+    bool setPosition(const std::string& fen, const std::vector<std::string>& moves, std::string& error);
+    // Forget everything learned from earlier games: TT and move-ordering statistics
+    void newGame();
+    void setMultiPV(int lines);
+    // The table is cleared; see Bot::setHashSize
+    bool setHashSize(size_t sizeInMB, std::string& error);
+    void setThreads(int threads);
+
+    // Searches the current position until a limit is reached or stop() is called; with no limit
+    // at all (and not infinite) it thinks for 5 seconds. onInfo gets every info line, on the
+    // calling thread; nothing is printed.
+    SearchResult search(const SearchLimits& limits, const InfoCallback& onInfo= nullptr);
+    // Stops the search() call in progress, also one still waiting to start: that one returns
+    // right away. A stop while no search() call is in progress is dropped, so a stop that
+    // crosses a search ending by itself does not cut the next one short.
+    void stop();
+    void ponderhit();
+
+  private:
+    std::unique_ptr<Bot> _bot;
+    std::mutex _mutex; // Held by every call but stop() and ponderhit()
+
+    // A stop can arrive after search() was called but before the search has started; it is
+    // kept here until that search has consumed it, so starting the search does not clear it
+    std::mutex _stopMutex;
+    bool _stopPending= false;
+    int _searchesInProgress= 0; // search() calls entered and not yet returned
+};
+
+} // namespace talawachess
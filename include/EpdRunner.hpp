@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Bot.hpp"
+#include "Move.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace talawachess {
+
+struct EpdOptions {
+    std::string path;                         // EPD file with bm/am (and optional id) operations
+    int workers= 0;                           // Positions solved in parallel, 0 for one per hardware thread
+    int movetimeMs= 10000;                    // Upper bound per position
+    int stableMs= 1000;                       // Stop once the best move has not changed for this long, 0 to never
+    size_t hashMB= 64;                        // TT size per worker
+    std::string label= "EPD";                 // "Label" column of the CSV
+    std::string csvPath= "benchmark_results.csv"; // Appended to, same columns as benchmark.sh
+};
+
+// Runs an EPD test suite inside one process: every worker thread has its own Bot and takes
+// the next unsolved position, so a suite runs at full core count without any process spawns.
+class EpdRunner {
+  public:
+    explicit EpdRunner(const EpdOptions& options);
+
+    // Returns the process exit code: 0 if every position was solved
+    int run();
+
+  private:
+    struct Position {
+        std::string fen;
+        std::string name;
+        std::vector<core::Move> bestMoves;  // bm: one of these has to be played
+        std::vector<core::Move> avoidMoves; // am: none of these may be played
+        std::string expected;               // For the CSV: "e2e4 d2d4" or "not g2g4"
+    };
+
+    struct Result {
+        bool solved= false;
+        int depth= 0;
+        uint64_t nodes= 0;
+        int timeMs= 0;    // Time to solution if solved, else the whole search
+        int totalMs= 0;
+        core::Move bestMove;
+    };
+
+    EpdOptions _options;
+    std::vector<Position> _positions;
+
+    bool load(std::string& error);
+    bool parseLine(const std::string& line, int lineNumber, Position& position, std::string& error);
+    bool isCorrect(const Position& position, const core::Move& move) const;
+    Result solve(Bot& bot, const Position& position);
+};
+
+} // namespace talawachess
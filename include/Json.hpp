@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+
+namespace talawachess::json {
+
+// Value of a flat JSON object member. Strings are unescaped; numbers, true/false/null keep
+// their literal text, so they can be echoed back unchanged.
+struct Value {
+    std::string text;
+    bool isString= false;
+
+    // The value as it would appear in JSON output
+    std::string toJson() const;
+};
+
+using Object= std::unordered_map<std::string, Value>;
+
+// Parses one line holding a flat JSON object (no nested objects or arrays).
+// Returns false and sets error on malformed input.
+bool parseObject(const std::string& line, Object& object, std::string& error);
+
+// Quotes and escapes a string for JSON output
+std::string quote(const std::string& text);
+
+} // namespace talawachess::json
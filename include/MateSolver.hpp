@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Board.hpp"
+#include "MoveGenerator.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace talawachess {
+
+// Depth-first proof-number (df-pn) search for forced mates.
+// Nodes are (position, plies remaining). At attacker nodes (OR) one mating move is enough,
+// at defender nodes (AND) every reply has to be refuted. Proof/disproof numbers are kept
+// from the side-to-move's point of view (phi/delta), so both node types share one routine.
+class MateSolver {
+  public:
+    struct Result {
+        bool found= false;
+        int mateIn= 0; // Moves (not plies) for the attacker
+        std::vector<core::Move> pv;
+        uint64_t nodes= 0;
+        bool stopped= false; // Interrupted by stop() or the time limit before finishing
+    };
+
+    explicit MateSolver(size_t hashSizeMB= 64);
+
+    // Searches for the shortest mate in at most maxMoves attacker moves, trying 1, 2, ... maxMoves.
+    // Prints UCI "info" lines for every distance it proves or refutes.
+    Result solve(const core::board::Board& board, int maxMoves, int timeLimitMs= 0);
+
+    void setChecksOnly(bool checksOnly) { _checksOnly= checksOnly; }
+    // Same contract as Bot: stop() may come from another thread, clearStop() before a new solve
+    void stop() { _stop= true; }
+    void clearStop() { _stop= false; }
+
+  private:
+    static constexpr uint32_t INF= 1000000000;
+
+    struct Entry {
+        uint64_t zobristHash= 0;
+        uint32_t phi= 1;   // Proof number for the side to move
+        uint32_t delta= 1; // Disproof number for the side to move
+        int16_t remaining= -1;
+        uint16_t generation= 0; // Solve that wrote it: entries of earlier solves read as empty
+    };
+
+    struct Child {
+        core::Move move;
+        uint64_t zobristHash;
+    };
+
+    core::board::Board _board;
+    core::board::MoveGenerator _moveGen;
+    std::vector<Entry> _table;
+    size_t _tableSize;       // Entries
+    uint16_t _generation= 0; // Current solve, never 0 once solving
+
+    bool _checksOnly= false; // Attacker only considers checking moves
+    std::atomic<bool> _stop= false;
+    uint64_t _nodes= 0;
+    int _rootRemaining= 0;
+
+    std::chrono::time_point<std::chrono::steady_clock> _startTime;
+    int _timeLimitMs= 0;
+
+    void checkStop();
+    int getElapsedTimeMs() const;
+
+    Entry& slot(uint64_t zobristHash, int remaining);
+    void lookup(uint64_t zobristHash, int remaining, uint32_t& phi, uint32_t& delta);
+    void store(uint64_t zobristHash, int remaining, uint32_t phi, uint32_t delta);
+
+    bool isAttacker(int remaining) const { return ((_rootRemaining - remaining) & 1) == 0; }
+    bool inCheck() const;
+    void generateChildren(int remaining, std::vector<Child>& children);
+    void mid(int remaining, uint32_t thPhi, uint32_t thDelta);
+    std::vector<core::Move> extractPV(int remaining);
+};
+
+} // namespace talawachess
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "Board.hpp"
+#include "MoveGenerator.hpp"
+#include <string>
+#include <string_view>
+
+namespace talawachess::core::board::notation {
+
+// Legal moves of the side to move
+void generateLegalMoves(Board& board, MoveList& legalMoves);
+
+// Rejects FENs the board parser would silently turn into nonsense: 8 ranks of 8 squares,
+// one king per side and a valid side to move. Returns false with the reason in error.
+bool validateFen(const std::string& fen, std::string& error);
+
+// Standard Algebraic Notation of a legal move in the given position, with +/# suffix.
+// The board is used as scratch space and restored before returning.
+std::string toSan(Board& board, const Move& move);
+
+// Finds the legal move written in SAN or UCI long algebraic ("e2e4", "e7e8q").
+// SAN is read leniently: capture marks, '=', check marks, annotations (!?) and
+// "0-0" castling are all accepted. Returns false if no legal move (or more than one) matches.
+bool parseMove(Board& board, const std::string& text, Move& move);
+
+// SAN only, with the same leniency, and without building any strings: this is the one to
+// use when replaying large game files
+bool parseSan(Board& board, std::string_view text, Move& move);
+
+} // namespace talawachess::core::board::notation
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Board.hpp"
+#include "Move.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace talawachess::pgn {
+
+// Read-only view of a whole file: memory-mapped where the platform allows, read into memory otherwise
+class MappedFile {
+  public:
+    MappedFile()= default;
+    ~MappedFile();
+    MappedFile(const MappedFile&)= delete;
+    MappedFile& operator=(const MappedFile&)= delete;
+
+    bool open(const std::string& path, std::string& error);
+    std::string_view text() const { return _text; }
+
+  private:
+    std::string_view _text;
+    void* _mapping= nullptr;
+    size_t _mappingBytes= 0;
+    std::string _contents; // Fallback without mmap
+    void close();
+};
+
+struct Tag {
+    std::string_view name;
+    std::string_view value; // Escapes are left as they are
+};
+
+// One game as views into the file text; valid as long as the file is
+struct Game {
+    std::vector<Tag> tags;
+    std::string_view movetext;
+
+    std::string_view tag(std::string_view name) const; // Empty if missing
+};
+
+// Splits PGN text into games without copying it
+class Reader {
+  public:
+    explicit Reader(std::string_view text): _rest(text) {}
+    // Reuses game's storage; false when no game is left
+    bool next(Game& game);
+
+  private:
+    std::string_view _rest;
+};
+
+// Takes the next move token off the front of movetext, skipping comments, variations, NAGs,
+// move numbers and the result. False once no move is left.
+bool nextMoveToken(std::string_view& movetext, std::string_view& token);
+
+// Position the game starts from (FEN tag or the standard start position)
+std::string startFen(const Game& game);
+
+// Resolves the game's moves, leaving board at the final position. Stops at the first token
+// that is not a legal move, returning false with the reason in error (the legal prefix is kept).
+bool replay(const Game& game, core::board::Board& board, std::vector<core::Move>& moves, std::string& error);
+
+} // namespace talawachess::pgn
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#ifdef TALAWA_PROFILE
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define TALAWA_PROFILE_RDTSC 1
+#endif
+#endif
+
+// Hot-path profiling zones. TALAWA_PROFILE_ZONE(ZONE) times the rest of the enclosing scope and
+// adds it to this thread's counters. Without TALAWA_PROFILE (cmake -DTALAWA_PROFILE=ON) the
+// macro expands to nothing, so production builds pay nothing for the instrumentation.
+namespace talawachess::profile {
+
+enum Zone {
+    SEARCH,     // A whole search on one thread: the reference for the other zones
+    MOVEGEN,    // MoveGenerator::generateMoves
+    MAKE_MOVE,  // Board::makeMove
+    UNDO_MOVE,  // Board::undoMove
+    ATTACKS,    // MoveGenerator::isSquareAttacked
+    EVALUATE,   // evaluator::evaluate
+    SORT_MOVES, // The sort in Bot::orderMoves
+    ZONE_COUNT
+};
+
+#ifdef TALAWA_PROFILE
+constexpr bool ENABLED= true;
+#else
+constexpr bool ENABLED= false;
+#endif
+
+// Breakdown of every zone since the last reset, summed over all threads, as "info string
+// profile" lines. Zones nest (ATTACKS runs inside MOVEGEN, for one), so their times are
+// inclusive. Only call while no search is running: the counters are plain, unsynchronized.
+std::string report();
+void reset();
+
+#ifdef TALAWA_PROFILE
+inline uint64_t ticks() {
+#ifdef TALAWA_PROFILE_RDTSC
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+struct alignas(64) Counters {
+    uint64_t ticks[ZONE_COUNT]= {};
+    uint64_t calls[ZONE_COUNT]= {};
+};
+
+// One per thread, registered for report() while the thread lives and folded into the totals
+// when it exits, so helper threads that come and go are still counted
+struct ThreadCounters {
+    Counters counters;
+    ThreadCounters();
+    ~ThreadCounters();
+};
+inline thread_local ThreadCounters threadCounters;
+
+class ScopedZone {
+  public:
+    explicit ScopedZone(Zone zone): _zone(zone), _start(ticks()) {}
+    ~ScopedZone() {
+        Counters& counters= threadCounters.counters;
+        counters.ticks[_zone]+= ticks() - _start;
+        counters.calls[_zone]++;
+    }
+    ScopedZone(const ScopedZone&)= delete;
+    ScopedZone& operator=(const ScopedZone&)= delete;
+
+  private:
+    Zone _zone;
+    uint64_t _start;
+};
+
+#define TALAWA_PROFILE_JOIN2(a, b) a##b
+#define TALAWA_PROFILE_JOIN(a, b) TALAWA_PROFILE_JOIN2(a, b)
+#define TALAWA_PROFILE_ZONE(zone) \
+    ::talawachess::profile::ScopedZone TALAWA_PROFILE_JOIN(profileZone, __LINE__)(::talawachess::profile::zone)
+#else
+#define TALAWA_PROFILE_ZONE(zone) ((void)0)
+#endif
+
+} // namespace talawachess::profile
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace talawachess {
+
+// Counters of one search thread. Every thread owns its copy, on cache lines of its own, and
+// only that thread writes it: counting is a plain increment with no cache-line traffic
+// between threads. The main thread sums the copies once the helpers have stopped.
+struct alignas(64) SearchStats {
+    uint64_t nodes= 0;  // Main search nodes
+    uint64_t qnodes= 0; // Quiescence nodes
+    uint64_t ttProbes= 0;
+    uint64_t ttHits= 0;
+    uint64_t ttCutoffs= 0; // Nodes answered by the TT score alone
+    uint64_t failHighs= 0;
+    uint64_t failHighsFirst= 0; // Cutoffs by the first legal move
+    uint64_t nullMoveTries= 0;
+    uint64_t nullMoveCutoffs= 0;
+    uint64_t lmrReductions= 0;
+    uint64_t lmrResearches= 0; // Reduced moves that beat alpha and were searched again
+    uint64_t mates= 0;         // Checkmates found
+
+    SearchStats& operator+=(const SearchStats& other);
+};
+
+// Statistics of a whole search, all threads together
+struct SearchReport {
+    SearchStats totals;
+    std::vector<uint64_t> iterationNodes; // Nodes spent on each completed depth, from depth 1
+    int threads= 1;
+    int timeMs= 0;
+    int hashfull= 0; // Per mille of the TT written by this search
+
+    // "info string stats ..." lines, each ending in a newline
+    std::string toInfoString() const;
+    // One line holding a JSON object
+    std::string toJson() const;
+};
+
+} // namespace talawachess
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace talawachess {
+
+// Measures how promptly searches react to their deadline or to "stop", accumulated per game.
+// The search thread owns everything except the stop request time, which the UCI thread writes.
+class SearchTelemetry {
+  public:
+    using Clock= std::chrono::steady_clock;
+
+    // Overshoot buckets (ms past the hard limit): <=0, 1-5, 6-10, 11-25, 26-50, 51-100, >100
+    static constexpr int OVERSHOOT_BUCKETS= 7;
+
+    // Search thread: a search with the given hard limit (0 for none, e.g. while pondering) starts now
+    void beginSearch(int hardLimitMs);
+    // Search thread: ponderhit turned the search into a timed one, measured from now
+    void clockStarted(Clock::time_point now, int hardLimitMs) {
+        _clockStart= now;
+        _hardLimitMs= hardLimitMs;
+    }
+    // Search thread: called from every time check
+    void timeChecked(Clock::time_point now);
+    // Search thread: the hard limit was found expired at a time check
+    void deadlineHit() { _deadlineHit= true; }
+
+    // Any thread: "stop" was received. The earliest request since clearStopRequest() counts.
+    void stopRequested();
+    void clearStopRequest() { _stopRequestNs= 0; }
+
+    // Called right before bestmove is printed; returns the "info string" line for this search
+    std::string endSearch();
+
+    // Multi-line "info string" dump of everything recorded since the last reset()
+    std::string summary() const;
+    void reset();
+
+  private:
+    // Current search
+    Clock::time_point _searchStart;
+    Clock::time_point _clockStart;
+    Clock::time_point _lastCheck;
+    int _hardLimitMs= 0;
+    bool _deadlineHit= false;
+    int64_t _maxCheckGapUs= 0;
+    uint64_t _checks= 0;
+    std::atomic<int64_t> _stopRequestNs= 0; // Clock ticks since epoch, 0 for none
+
+    // Per game
+    int _searches= 0;
+    int _timedSearches= 0;
+    int _deadlineHits= 0;
+    int _stopCommands= 0;
+    int64_t _maxLatencyUs= 0;   // Deadline or stop until bestmove
+    int64_t _totalLatencyUs= 0;
+    int _latencySamples= 0;
+    int64_t _maxOvershootUs= 0; // Hard limit until bestmove
+    int64_t _gameMaxCheckGapUs= 0;
+    std::array<int, OVERSHOOT_BUCKETS> _overshootHistogram{};
+
+    static int overshootBucket(int64_t overshootUs);
+};
+
+} // namespace talawachess
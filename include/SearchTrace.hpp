@@ -0,0 +1,91 @@
+#pragma once
+
+#include "Move.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Search tree trace: one fixed-size record per main-search node, written when the node
+// returns, so a node's subtree is the run of records right before it with a greater ply.
+// Recording is compiled in with TALAWA_TRACE (cmake -DTALAWA_TRACE=ON) and switched on with
+// the TraceFile option; without the define the search contains no trace code at all. Only the
+// main thread records. talawachess_trace reads the files.
+namespace talawachess::trace {
+
+// Why a node returned
+enum Reason : uint8_t {
+    SEARCHED,     // Every move searched: exact or fail low, see score against the window
+    BETA_CUTOFF,  // A move reached beta
+    TT_CUTOFF,    // The TT score alone decided it
+    RFP,          // Reverse futility pruning
+    NULL_MOVE,    // Null move search reached beta
+    QSEARCH,      // Depth ran out: the score is the quiescence search's
+    DRAW,         // Repetition or fifty-move rule
+    MATE,         // Checkmated
+    STALEMATE,
+    MAX_DEPTH,    // Search stack exhausted, static evaluation
+    STOPPED,      // Aborted by stop or the time limit: the score means nothing
+    SEARCH_START, // Marker before every search: hash is the root position, depth the depth limit
+    REASON_COUNT
+};
+const char* reasonName(Reason reason);
+
+// Flag bits
+static constexpr uint8_t FLAG_VERIFICATION= 1; // Singular extension search at the parent's ply, excluding the TT move
+
+#pragma pack(push, 1)
+struct Record {
+    uint64_t hash;
+    int32_t alpha; // Window on entry
+    int32_t beta;
+    int32_t score; // Returned score
+    uint16_t move; // Move into this node (encodeMove), 0 for a null move
+    uint8_t ply;
+    int8_t depth;
+    int8_t reduction; // Applied by the parent (LMR, or R for a null move search)
+    int8_t extension;
+    uint8_t reason;    // Reason
+    uint8_t iteration; // Root depth of the iteration
+    uint8_t flags;
+    uint8_t reserved[3];
+};
+#pragma pack(pop)
+static_assert(sizeof(Record) == 32, "Record is a fixed on-disk layout");
+
+// from (6 bits) | to (6 bits) | promotion piece type (3 bits)
+uint16_t encodeMove(const core::Move& move);
+std::string moveToString(uint16_t move); // "e7e8q", or "null"
+
+// File layout: a 16-byte header ("TLWTRAC", a zero byte, format version, record size), then
+// records back to back. Multi-byte fields are little-endian.
+static constexpr char FILE_MAGIC[8]= {'T', 'L', 'W', 'T', 'R', 'A', 'C', '\0'};
+static constexpr uint32_t FILE_VERSION= 1;
+
+// Collects records in a fixed buffer and writes it to the file whenever it fills up, so the
+// search only ever does a store per node
+class Recorder {
+  public:
+    explicit Recorder(size_t bufferRecords= 1 << 16);
+    ~Recorder();
+    Recorder(const Recorder&)= delete;
+    Recorder& operator=(const Recorder&)= delete;
+
+    // Creates (truncates) the file and writes its header
+    bool open(const std::string& path, std::string& error);
+    void record(const Record& record) {
+        _buffer[_count++]= record;
+        if(_count == _buffer.size()) flush();
+    }
+    void flush();
+
+  private:
+    std::FILE* _file= nullptr;
+    std::vector<Record> _buffer;
+    size_t _count= 0;
+};
+
+// Loads a whole trace file
+bool readFile(const std::string& path, std::vector<Record>& records, std::string& error);
+
+} // namespace talawachess::trace
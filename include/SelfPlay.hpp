@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Board.hpp"
+#include "Bot.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace talawachess {
+
+struct SelfPlayOptions {
+    std::string devParams;        // SearchParams of the engine under test, "name=value,..."
+    std::string baseParams;       // SearchParams of the reference engine
+    std::string openingsPath;     // EPD (first four fields) or PGN (first openingPlies plies); empty: start position
+    int openingPlies= 8;          // Plies taken from each PGN game
+    int games= 20000;             // Upper bound; SPRT usually ends the match earlier
+    int concurrency= 0;           // Games played in parallel, 0 for one per hardware thread
+    int baseTimeMs= 2000;         // Time control: base + increment per move
+    int incrementMs= 20;
+    size_t hashMB= 16;            // TT size per engine per game slot
+
+    // SPRT of H0: elo = elo0 against H1: elo = elo1, with error rates alpha and beta
+    double elo0= 0.0;
+    double elo1= 5.0;
+    double alpha= 0.05;
+    double beta= 0.05;
+
+    // Adjudication: a win once the score has been at least resignScore for the same side
+    // for resignMoves moves of both engines; a draw after drawMoveNumber once both have
+    // reported |score| <= drawScore for drawMoves moves
+    int resignScore= 1000;
+    int resignMoves= 3;
+    int drawScore= 10;
+    int drawMoves= 8;
+    int drawMoveNumber= 40;
+    int maxPlies= 400; // Draw when reached
+};
+
+// Finished game from the point of view of white
+enum class GameResult { WHITE_WIN, DRAW, BLACK_WIN };
+
+// Draw by the fifty-move rule, threefold repetition or insufficient material
+bool isDrawByRule(const core::board::Board& board);
+
+// Plays a match between two SearchParams configurations of the same engine, many games at a
+// time inside one process. Every opening is played twice with colours reversed.
+class SelfPlay {
+  public:
+    explicit SelfPlay(const SelfPlayOptions& options);
+
+    // Returns the process exit code: 1 if the SPRT accepted H0 (or setup failed), else 0
+    int run();
+
+  private:
+    struct Score {
+        int wins= 0; // From dev's point of view
+        int draws= 0;
+        int losses= 0;
+        int games() const { return wins + draws + losses; }
+    };
+
+    SelfPlayOptions _options;
+    SearchParams _devParams;
+    SearchParams _baseParams;
+    std::vector<std::string> _openings; // FENs
+
+    bool loadOpenings(std::string& error);
+    GameResult playGame(Bot& white, Bot& black, const std::string& fen, std::string& reason) const;
+    double llr(const Score& score) const;
+    static double elo(double score);
+};
+
+} // namespace talawachess
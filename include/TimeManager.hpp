@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Piece.hpp"
+#include <cstdint>
+
+namespace talawachess {
+
+// Limits parsed from a UCI "go" command. Zero means "not given".
+struct SearchLimits {
+    int wtime= 0;     // White time remaining (ms)
+    int btime= 0;     // Black time remaining (ms)
+    int winc= 0;      // White increment (ms)
+    int binc= 0;      // Black increment (ms)
+    int movestogo= 0; // Moves until the next time control, 0 for sudden death
+    int movetime= 0;  // Fixed move time (ms)
+    int depth= 0;     // Maximum depth in plies
+    uint64_t nodes= 0; // Maximum nodes, summed over all search threads
+    int mate= 0;      // "go mate N": look for a forced mate in N moves
+    bool infinite= false;
+    bool ponder= false; // "go ponder": think on the opponent's time until ponderhit or stop (armed by Bot::setPondering)
+
+    bool hasClock() const { return wtime > 0 || btime > 0; }
+};
+
+// Decides how long a search may run.
+// The hard limit is never exceeded (checked inside the search); the soft limit is only
+// consulted between iterations and is scaled by how settled the search looks.
+class TimeManager {
+  public:
+    void init(const SearchLimits& limits, core::Piece::Color us, int moveOverheadMs);
+
+    bool isTimed() const { return _hardLimitMs > 0; }
+    int softLimitMs() const { return _softLimitMs; }
+    int hardLimitMs() const { return _hardLimitMs; }
+
+    // Called after every completed iteration with the root statistics of that iteration.
+    // bestMoveNodeFraction is the share of all nodes spent below the best move.
+    // Returns true when the next iteration should not be started.
+    bool shouldStop(int elapsedMs, bool bestMoveChanged, int score, double bestMoveNodeFraction);
+
+    // Soft limit after the adjustments made by the last shouldStop() call
+    int adjustedSoftLimitMs() const { return _adjustedSoftLimitMs; }
+
+  private:
+    int _softLimitMs= 0;
+    int _hardLimitMs= 0;
+    int _adjustedSoftLimitMs= 0;
+    bool _fixedTime= false; // movetime or default budget: always use all of it
+
+    int _stableIterations= 0; // Consecutive iterations without a best move change
+    int _previousScore= 0;
+    bool _hasPreviousScore= false;
+};
+
+} // namespace talawachess
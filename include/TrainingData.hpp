@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Board.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace talawachess::data {
+
+// One scored training position in 32 bytes. Pieces are stored in square order (a1 = 0):
+// bit i of occupancy marks square i, and the k-th occupied square's piece is nibble k of
+// pieces (low nibble first), coded as type (1-6) | 8 for black.
+// Score and result are from white's point of view. Multi-byte fields are little-endian.
+#pragma pack(push, 1)
+struct PackedPosition {
+    uint64_t occupancy;
+    uint8_t pieces[16];
+    uint8_t flags;          // Bit 0: black to move, bits 1-4: castling rights (Board::CASTLE_*)
+    uint8_t enPassant;      // Target square index, 64 for none
+    uint8_t halfMoveClock;
+    uint8_t result;         // 0 black won, 1 draw, 2 white won
+    int16_t score;          // Search score in centipawns
+    uint16_t fullMoveNumber;
+};
+#pragma pack(pop)
+static_assert(sizeof(PackedPosition) == 32, "PackedPosition is a fixed on-disk layout");
+
+PackedPosition pack(const core::board::Board& board, int whiteScore, int result);
+// Restores the position into board (no move history)
+void unpack(const PackedPosition& packed, core::board::Board& board);
+
+// File layout: a 16-byte header ("TLWDATA", a zero byte, format version, record size), then
+// records back to back. Files only ever grow, so a generator can be stopped and resumed.
+static constexpr char FILE_MAGIC[8]= {'T', 'L', 'W', 'D', 'A', 'T', 'A', '\0'};
+static constexpr uint32_t FILE_VERSION= 1;
+
+class DataWriter {
+  public:
+    DataWriter()= default;
+    ~DataWriter();
+    DataWriter(const DataWriter&)= delete;
+    DataWriter& operator=(const DataWriter&)= delete;
+
+    // Opens for appending; writes the header if the file is new, checks it otherwise
+    bool open(const std::string& path, std::string& error);
+    void write(const PackedPosition* records, size_t count);
+    void flush();
+    void close();
+
+  private:
+    std::FILE* _file= nullptr;
+    std::vector<PackedPosition> _buffer;
+};
+
+// Streams records without loading the file: memory use is one read buffer
+class DataReader {
+  public:
+    DataReader()= default;
+    ~DataReader();
+    DataReader(const DataReader&)= delete;
+    DataReader& operator=(const DataReader&)= delete;
+
+    bool open(const std::string& path, std::string& error);
+    // Next record, false at the end of the file
+    bool next(PackedPosition& record);
+    uint64_t recordCount() const { return _recordCount; } // From the file size
+    void close();
+
+  private:
+    std::FILE* _file= nullptr;
+    std::vector<PackedPosition> _buffer;
+    size_t _bufferPos= 0;
+    uint64_t _recordCount= 0;
+};
+
+} // namespace talawachess::data
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "Move.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace talawachess {
+
+// Transposition Table Flags
+enum TTFlag : uint8_t {
+    TT_EXACT, // We know the exact score
+    TT_ALPHA, // Upper Bound (We know the score is at most this)
+    TT_BETA   // Lower Bound (We know the score is at least this)
+};
+
+// Unpacked view of a table entry. The move only carries from/to/promotion.
+struct TTData {
+    core::Move bestMove;
+    int score= 0; // 16 bits in the table: callers keep scores within int16_t
+    int depth= -1;
+    TTFlag flag= TT_EXACT;
+};
+
+// Transposition table shared by all search threads without locks.
+// The table is an array of 64-byte buckets (one cache line), each holding eight entries of
+// one 64-bit word: a 16-bit key check plus the packed data. A word is read and written as a
+// single atomic, so an entry is never torn, not even between processes sharing the table.
+// The bucket index comes from the high bits of the hash (multiply-shift) and the key check
+// from the low bits, so different positions in one bucket rarely share a key.
+class TranspositionTable {
+  public:
+    explicit TranspositionTable(size_t sizeInMB);
+    ~TranspositionTable();
+    TranspositionTable(const TranspositionTable&)= delete;
+    TranspositionTable& operator=(const TranspositionTable&)= delete;
+
+    // Drops a shared segment, if attached, and allocates a private table. The new table is
+    // mapped zero-filled and backed lazily, so even a large one costs nothing until it is used.
+    void resize(size_t sizeInMB);
+    // Zeroes every entry, split over threadCount threads. Only call while no search is running.
+    // A shared segment is only cleared by the process that created it, one atomic store per
+    // entry since others may be searching it: returns false, leaving it alone, elsewhere.
+    bool clear(int threadCount= 1);
+    // Touches a freshly allocated private table now, zeroing it on every core, so its page
+    // faults are not paid during the first timed search. Does nothing once the table has been
+    // cleared. Only call while no search is running.
+    void prefault();
+
+    // Backs the table with the named POSIX shared-memory segment, creating it with sizeInMB
+    // if it does not exist yet; an existing segment keeps its size. Other processes attaching
+    // to the same name share all entries. The segment outlives the processes (remove it from
+    // /dev/shm when done). Returns false, keeping the current table, if shared memory is
+    // unavailable (e.g. on Windows) or the segment cannot be used; error says why.
+    bool attachShared(const std::string& name, size_t sizeInMB, std::string& error);
+    // Same, backed by a regular file instead: the entries persist across runs, so a restarted
+    // analysis starts warm. The file is created with sizeInMB if it does not exist yet, and
+    // rejected if it was written with a different entry layout or set of Zobrist keys.
+    bool attachFile(const std::string& path, size_t sizeInMB, std::string& error);
+    // True for a shared segment or a file-backed table
+    bool isShared() const { return _mapping != nullptr; }
+    size_t sizeInMB() const { return (_bucketCount * sizeof(Bucket)) / (1024 * 1024); }
+
+    // Writes a snapshot of every entry to path; loading it restores the table exactly. A
+    // private table takes the snapshot's size, a shared one must already have it. Snapshots
+    // are versioned and carry a fingerprint of the Zobrist keys, so stale files are rejected
+    // rather than producing wrong hits. Only call while no search is running.
+    bool save(const std::string& path, std::string& error) const;
+    bool load(const std::string& path, std::string& error);
+
+    // Per mille of the entries written or used by the current search generation, from a
+    // sample of the first 1000 entries (UCI "hashfull")
+    int hashfull() const;
+
+    // Starts a new search generation: entries from older searches become preferred victims
+    void newSearch() { _generation= (_generation + 1) & GENERATION_MASK; }
+
+    // Returns true if the entry for zobristHash is present; on a miss data is left empty
+    // (depth -1). A hit also marks the entry as used by the current search.
+    bool probe(uint64_t zobristHash, TTData& data) const;
+    // Overwrites the entry for zobristHash if present, else the bucket's least valuable
+    // entry: the shallowest, counting every search generation of age as 8 plies
+    void store(uint64_t zobristHash, const core::Move& bestMove, int score, int depth, TTFlag flag);
+
+    // Pulls the bucket of zobristHash into the cache ahead of the probe
+    void prefetch(uint64_t zobristHash) const {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(&bucket(zobristHash));
+#endif
+    }
+
+  private:
+    static constexpr int BUCKET_ENTRIES= 8;
+    struct alignas(64) Bucket {
+        std::atomic<uint64_t> entries[BUCKET_ENTRIES]= {};
+    };
+    static_assert(sizeof(Bucket) == 64, "A bucket is one cache line");
+
+    // Start of a shared segment or table file; buckets follow it
+    struct alignas(64) SharedHeader {
+        std::atomic<uint64_t> magic; // Published last, once the rest is valid
+        uint64_t bucketCount;
+        uint64_t zobristFingerprint;
+    };
+    static constexpr uint64_t SHARED_MAGIC= 0x5441'4C41'5754'5403ULL; // "TALAWTT" + layout version 3
+
+    static constexpr int GENERATION_MASK= 31; // 5 bits
+
+    Bucket* _buckets= nullptr;
+    size_t _bucketCount= 0;
+    void* _memory= nullptr; // Private table
+    size_t _memoryBytes= 0;
+    bool _untouched= false; // Private table still lazily backed: never cleared
+    void* _mapping= nullptr; // Shared or file-backed table
+    size_t _mappingBytes= 0;
+    bool _mayClearMapping= false; // A table file, or a segment this process created
+    uint8_t _generation= 0;
+    void allocate(size_t bucketCount); // Private table
+    void releaseOwned();
+    void releaseShared();
+    bool attachMapping(int fd, bool creator, size_t sizeInMB, const std::string& label, std::string& error);
+
+    // (hash * bucketCount) >> 64: a uniform index without a division
+    Bucket& bucket(uint64_t zobristHash) const {
+#if defined(__SIZEOF_INT128__)
+        return _buckets[static_cast<size_t>((static_cast<unsigned __int128>(zobristHash) * _bucketCount) >> 64)];
+#else
+        uint64_t high= zobristHash >> 32, low= zobristHash & 0xFFFFFFFF;
+        uint64_t count= _bucketCount; // Fits in 32 bits for any realistic table
+        return _buckets[static_cast<size_t>((high * count + ((low * count) >> 32)) >> 32)];
+#endif
+    }
+    static uint16_t keyOf(uint64_t zobristHash) { return static_cast<uint16_t>(zobristHash); }
+    static uint64_t pack(uint16_t key, const core::Move& bestMove, int score, int depth, TTFlag flag, uint8_t generation);
+    static void unpack(uint64_t packed, TTData& data);
+};
+
+} // namespace talawachess
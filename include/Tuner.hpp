@@ -0,0 +1,50 @@
+#pragma once
+
+#include "TrainingData.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace talawachess {
+
+struct TunerOptions {
+    std::string dataPath;                      // datagen output
+    std::string outputPath= "include/EvalParams.hpp";
+    uint64_t limit= 0;                         // Positions loaded, 0 for all
+    int epochs= 300;
+    double learningRate= 1.0;                  // Adam step size, in centipawns
+    double lambda= 0.0;                        // Target: lambda * sigmoid(search score) + (1 - lambda) * game result
+    int threads= 0;                            // 0 for one per hardware thread
+};
+
+// Texel tuning of the material and piece-square values in EvalParams.hpp: minimizes the mean
+// squared error between sigmoid(eval) and the game result, with full-batch Adam.
+// The evaluation is linear in its parameters, so positions stay in their 32-byte packed
+// form and every epoch decodes them on the fly.
+class Tuner {
+  public:
+    explicit Tuner(const TunerOptions& options);
+
+    // Returns the process exit code
+    int run();
+
+  private:
+    // Parameter layout: PieceValues[7], then PieceSquareTables[7][64]
+    static const int PARAM_COUNT= 7 + 7 * 64;
+    static int valueIndex(int type) { return type; }
+    static int squareIndex(int type, int square) { return 7 + type * 64 + square; }
+
+    TunerOptions _options;
+    std::vector<data::PackedPosition> _positions;
+    std::vector<double> _params;
+    int _threadCount= 1;
+
+    bool load(std::string& error);
+    double evaluate(const data::PackedPosition& position, const std::vector<double>& params) const;
+    // Mean loss over all positions; adds d(loss)/d(param) into gradient when given
+    double loss(double k, std::vector<double>* gradient) const;
+    double fitScalingConstant() const;
+    bool writeHeader(std::string& error) const;
+};
+
+} // namespace talawachess
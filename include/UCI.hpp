@@ -1,5 +1,9 @@
 #include "Board.hpp"
 #include "Bot.hpp"
+#include "MateSolver.hpp"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <string>
 #include <thread>
 namespace talawachess {
@@ -7,6 +11,21 @@ class UCI {
   private:
     const std::string ENGINE_NAME= "Talawa";
     Bot _bot;
+    MateSolver _mateSolver;
+
+    // Commands read by the input thread, consumed by listen()
+    std::deque<std::string> _commands;
+    std::mutex _commandsMutex;
+    std::condition_variable _commandsAvailable;
+    std::thread _inputThread;
+    std::thread _searchThread;
+    std::string _searchStats= "off"; // "SearchStats" option: off, info or json, printed before bestmove
+    std::string _lastGameTelemetry;  // Summary of the game ended by the last ucinewgame
+
+    void readInput();
+    std::string nextCommand();
+    void stopSearch();
+    void runSearch(SearchLimits limits);
 
   public:
     UCI()= default;
@@ -0,0 +1,75 @@
+/* C API of the talawachess_core library: a thin wrapper over talawachess::Engine (Engine.hpp).
+ * Every engine is independent; many can search concurrently on different threads. Calls on one
+ * engine are serialized, except talawa_engine_stop, which may come from any thread. */
+#ifndef TALAWACHESS_H
+#define TALAWACHESS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct talawa_engine talawa_engine;
+
+/* Zero means no limit of that kind. With all of them zero (or limits NULL) the engine thinks
+ * for its default 5 seconds; set infinite to search until talawa_engine_stop. */
+typedef struct talawa_limits {
+    int depth;
+    int movetime_ms;
+    uint64_t nodes;
+    int wtime_ms, btime_ms, winc_ms, binc_ms;
+    int movestogo;
+    int infinite;
+} talawa_limits;
+
+typedef struct talawa_info {
+    int depth;
+    int multipv;
+    int score_cp; /* Unless is_mate */
+    int is_mate;
+    int mate_in;  /* Moves, negative when the side to move gets mated */
+    int time_ms;
+    uint64_t nodes;
+    uint64_t nps;
+    int hashfull; /* Per mille */
+    const char* pv; /* UCI moves separated by spaces; only valid during the callback */
+} talawa_info;
+
+typedef struct talawa_result {
+    char best_move[6];   /* UCI move, "" when the side to move has no legal move */
+    char ponder_move[6]; /* May be "" */
+    int score_cp;        /* Unless is_mate */
+    int is_mate;
+    int mate_in;
+    int depth;
+    uint64_t nodes;
+    int time_ms;
+} talawa_result;
+
+/* Runs on the thread that called talawa_engine_search */
+typedef void (*talawa_info_callback)(const talawa_info* info, void* user_data);
+
+/* NULL if the engine cannot be created (out of memory) */
+talawa_engine* talawa_engine_create(size_t hash_mb, int threads);
+/* Stops a running search and waits for it */
+void talawa_engine_destroy(talawa_engine* engine);
+
+/* fen is "startpos" or a FEN, moves UCI moves separated by spaces (or NULL). Returns 0, or -1
+ * with the reason written to error (error_size bytes, may be NULL) and the position unchanged. */
+int talawa_engine_set_position(talawa_engine* engine, const char* fen, const char* moves, char* error, size_t error_size);
+void talawa_engine_new_game(talawa_engine* engine);
+void talawa_engine_set_multipv(talawa_engine* engine, int lines);
+
+/* Blocks until the search ends; on_info may be NULL. Returns 0, or -1 on failure. */
+int talawa_engine_search(talawa_engine* engine, const talawa_limits* limits, talawa_info_callback on_info, void* user_data,
+                         talawa_result* result);
+/* Stops the talawa_engine_search call in progress (also one not started yet); dropped when none is */
+void talawa_engine_stop(talawa_engine* engine);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TALAWACHESS_H */
@@ -1,8 +1,8 @@
 #!/bin/bash
 
 # Configuration
-BINARY="./build/talawachess.exe"
-TEST_FILE="tests.txt"
+BINARY="${BINARY:-./build/talawachess.exe}"
+TEST_FILE="${TEST_FILE:-tests.txt}"
 
 # Colors for output
 GREEN='\033[0;32m'
@@ -21,10 +21,12 @@ echo "=========================================================="
 
 # Read the file line by line
 # We use '|' as the separator (IFS)
-while IFS='|' read -r fen expected_move_raw; do
+while IFS='|' read -r fen expected_move_raw go_args; do
     # 1. Clean up inputs (trim whitespace/comments)
     fen=$(echo "$fen" | xargs) 
     expected_move=$(echo "$expected_move_raw" | xargs)
+    go_args=$(echo "$go_args" | xargs)
+    go_args=${go_args:-movetime 10000}
 
     # Skip empty lines or comments
     if [[ -z "$fen" || "$fen" == \#* ]]; then
@@ -34,15 +36,18 @@ while IFS='|' read -r fen expected_move_raw; do
     echo -n "Testing: $expected_move ... "
 
     # 2. Prepare Engine Input
-    # We ask the engine to go, then quit.
-    input="position fen $fen\ngo movetime 10000 \nquit\n"
+    # We ask the engine to go, then quit once it has answered ("quit" stops a running search).
+    input="position fen $fen\ngo $go_args \n"
+    output_file=$(mktemp)
 
     # 3. Run Engine and Capture Output + Time
     # We use date +%s%N to get nanoseconds for precision
     start_time=$(date +%s%N)
     
     # Run the engine
-    engine_output=$(printf "$input" | $BINARY)
+    (printf "$input"; until grep -q "^bestmove" "$output_file"; do sleep 0.1; done; echo quit) | $BINARY > "$output_file"
+    engine_output=$(cat "$output_file")
+    rm -f "$output_file"
     
     end_time=$(date +%s%N)
     
@@ -0,0 +1,369 @@
+#include "AnalysisServer.hpp"
+#include "Notation.hpp"
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+#include <sstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <arpa/inet.h>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define TALAWA_HAS_SOCKETS 1
+#endif
+
+namespace talawachess {
+
+AnalysisServer::AnalysisServer(const ServerOptions& options): _options(options) {}
+
+AnalysisServer::~AnalysisServer() {
+    shutdown();
+}
+
+static std::string errorLine(const json::Value* id, const std::string& message) {
+    std::string line= "{";
+    if(id != nullptr) line+= "\"id\":" + id->toJson() + ",";
+    return line + "\"type\":\"error\",\"message\":" + json::quote(message) + "}";
+}
+
+static bool sameId(const json::Value& a, const json::Value& b) {
+    return a.isString == b.isString && a.text == b.text;
+}
+
+bool AnalysisServer::parseJob(const json::Object& request, Job& job, std::string& error) {
+    auto text= [&request](const char* key) -> const json::Value* {
+        auto it= request.find(key);
+        return it == request.end() ? nullptr : &it->second;
+    };
+    auto readInt= [&](const char* key, int& out) {
+        const json::Value* value= text(key);
+        if(value == nullptr) return true;
+        try {
+            out= std::stoi(value->text);
+        } catch(const std::exception&) {
+            error= std::string("\"") + key + "\" must be an integer";
+            return false;
+        }
+        return true;
+    };
+
+    const json::Value* fen= text("fen");
+    job.fen= (fen == nullptr || fen->text == "startpos") ? core::board::Board::STARTING_POS : fen->text;
+    if(!core::board::notation::validateFen(job.fen, error)) return false;
+
+    if(const json::Value* moves= text("moves")) {
+        std::istringstream ss(moves->text);
+        std::string move;
+        while(ss >> move) job.moves.push_back(move);
+    }
+
+    SearchLimits& limits= job.limits;
+    if(!readInt("depth", limits.depth) || !readInt("movetime", limits.movetime) ||
+       !readInt("wtime", limits.wtime) || !readInt("btime", limits.btime) ||
+       !readInt("winc", limits.winc) || !readInt("binc", limits.binc) ||
+       !readInt("movestogo", limits.movestogo) || !readInt("multipv", job.multiPV)) {
+        return false;
+    }
+    const json::Value* infinite= text("infinite");
+    limits.infinite= infinite != nullptr && infinite->text == "true";
+    job.multiPV= std::clamp(job.multiPV, 1, 256);
+    return true;
+}
+
+void AnalysisServer::handleRequest(const std::shared_ptr<Connection>& connection, const std::string& line) {
+    json::Object request;
+    std::string error;
+    if(!json::parseObject(line, request, error)) {
+        connection->send(errorLine(nullptr, error));
+        return;
+    }
+    auto idIt= request.find("id");
+    const json::Value* id= idIt == request.end() ? nullptr : &idIt->second;
+    auto cmdIt= request.find("cmd");
+    std::string command= cmdIt == request.end() ? "analyse" : cmdIt->second.text;
+
+    if(command == "stop") {
+        stopJobs(connection.get(), id);
+    } else if(command == "shutdown") {
+        _shutdown= true;
+        stopJobs(nullptr, nullptr);
+        _jobsAvailable.notify_all();
+    } else if(command == "analyse" || command == "analyze") {
+        Job job;
+        job.connection= connection;
+        if(id != nullptr) job.id= *id;
+        if(!parseJob(request, job, error)) {
+            connection->send(errorLine(id, error));
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(_jobsMutex);
+            _jobs.push_back(std::move(job));
+        }
+        _jobsAvailable.notify_one();
+    } else {
+        connection->send(errorLine(id, "unknown cmd \"" + command + "\""));
+    }
+}
+
+// Stops the matching jobs: all jobs (connection == nullptr), all of a connection (id == nullptr)
+// or one job. Queued jobs are dropped with an error reply, running ones end with their bestmove.
+void AnalysisServer::stopJobs(const Connection* connection, const json::Value* id) {
+    auto matches= [&](const Job& job) {
+        if(connection == nullptr) return true;
+        return job.connection.get() == connection && (id == nullptr || sameId(job.id, *id));
+    };
+
+    std::vector<Job> dropped;
+    {
+        std::lock_guard<std::mutex> lock(_jobsMutex);
+        for(auto it= _jobs.begin(); it != _jobs.end();) {
+            if(matches(*it)) {
+                dropped.push_back(std::move(*it));
+                it= _jobs.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        for(auto& worker: _workers) {
+            if(worker.running != nullptr && matches(*worker.running)) worker.bot->stopSearch();
+        }
+    }
+    for(const auto& job: dropped) {
+        job.connection->send(errorLine(&job.id, "stopped before it started"));
+    }
+}
+
+void AnalysisServer::workerLoop(Worker& worker) {
+    while(true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(_jobsMutex);
+            _jobsAvailable.wait(lock, [this] { return _shutdown || !_jobs.empty(); });
+            if(_shutdown) return;
+            job= std::move(_jobs.front());
+            _jobs.pop_front();
+            // Registered and cleared under the lock, so a stop can never fall in between
+            worker.running= &job;
+            worker.bot->clearStop();
+        }
+        if(!job.connection->closed) runJob(*worker.bot, job);
+        std::lock_guard<std::mutex> lock(_jobsMutex);
+        worker.running= nullptr;
+    }
+}
+
+void AnalysisServer::runJob(Bot& bot, const Job& job) {
+    std::string id= job.id.toJson();
+    bot.resetHeuristics();
+    bot.setFen(job.fen);
+    try {
+        for(const auto& move: job.moves) bot.performMove(move);
+    } catch(const std::invalid_argument& e) {
+        job.connection->send(errorLine(&job.id, e.what()));
+        return;
+    }
+    bot.setMultiPV(job.multiPV);
+    bot.setInfoCallback([&](const SearchInfo& info) {
+        std::ostringstream line;
+        line << "{\"id\":" << id << ",\"type\":\"info\",\"depth\":" << info.depth << ",\"multipv\":" << info.multiPV
+             << ",\"score\":{\"" << (info.isMate ? "mate" : "cp") << "\":" << (info.isMate ? info.mateIn : info.score) << "}"
+             << ",\"time\":" << info.timeMs << ",\"nodes\":" << info.nodes << ",\"nps\":" << info.nps << ",\"pv\":\"";
+        for(size_t i= 0; i < info.pv.size(); ++i) line << (i > 0 ? " " : "") << info.pv[i].ToString();
+        line << "\"}";
+        if(!job.connection->send(line.str())) bot.stopSearch(); // Nobody is listening any more
+    });
+
+    core::Move bestMove= bot.getBestMove(job.limits).first;
+    bot.setInfoCallback(nullptr);
+
+    const core::Move& ponderMove= bot.getPonderMove();
+    std::string line= "{\"id\":" + id + ",\"type\":\"bestmove\",\"bestmove\":";
+    line+= bestMove.from == bestMove.to ? "null" : "\"" + bestMove.ToString() + "\"";
+    if(ponderMove.from != ponderMove.to) line+= ",\"ponder\":\"" + ponderMove.ToString() + "\"";
+    job.connection->send(line + "}");
+}
+
+#ifdef TALAWA_HAS_SOCKETS
+
+bool AnalysisServer::Connection::send(const std::string& line) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    if(closed || fd < 0) return false;
+    std::string data= line + "\n";
+    size_t written= 0;
+    while(written < data.size()) {
+        ssize_t n= ::write(fd, data.data() + written, data.size() - written);
+        if(n < 0 && errno == EINTR) continue;
+        if(n <= 0) {
+            closed= true;
+            return false;
+        }
+        written+= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool AnalysisServer::openListener(std::string& error) {
+    if(!_options.socketPath.empty()) {
+        sockaddr_un address{};
+        address.sun_family= AF_UNIX;
+        if(_options.socketPath.size() >= sizeof(address.sun_path)) {
+            error= "socket path too long: " + _options.socketPath;
+            return false;
+        }
+        std::strcpy(address.sun_path, _options.socketPath.c_str());
+        _listenFd= socket(AF_UNIX, SOCK_STREAM, 0);
+        unlink(_options.socketPath.c_str()); // Left behind by an earlier run
+        if(_listenFd < 0 || bind(_listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            error= "cannot bind " + _options.socketPath + ": " + std::strerror(errno);
+            return false;
+        }
+    } else {
+        sockaddr_in address{};
+        address.sin_family= AF_INET;
+        address.sin_addr.s_addr= htonl(INADDR_LOOPBACK); // Local clients only
+        address.sin_port= htons(static_cast<uint16_t>(_options.port));
+        _listenFd= socket(AF_INET, SOCK_STREAM, 0);
+        int reuse= 1;
+        if(_listenFd >= 0) setsockopt(_listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        if(_listenFd < 0 || bind(_listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            error= "cannot bind 127.0.0.1:" + std::to_string(_options.port) + ": " + std::strerror(errno);
+            return false;
+        }
+    }
+    if(listen(_listenFd, 64) != 0) {
+        error= std::string("listen: ") + std::strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+void AnalysisServer::serveConnection(std::shared_ptr<Connection> connection) {
+    std::string buffer;
+    char chunk[4096];
+    while(!_shutdown) {
+        ssize_t n= recv(connection->fd, chunk, sizeof(chunk), 0);
+        if(n < 0 && errno == EINTR) continue;
+        if(n <= 0) break;
+        buffer.append(chunk, static_cast<size_t>(n));
+        size_t newline;
+        while((newline= buffer.find('\n')) != std::string::npos) {
+            std::string line= buffer.substr(0, newline);
+            buffer.erase(0, newline + 1);
+            if(!line.empty() && line.back() == '\r') line.pop_back();
+            if(!line.empty()) handleRequest(connection, line);
+        }
+    }
+    // The client is gone (or we are shutting down): nothing it asked for is worth finishing
+    connection->closed= true;
+    stopJobs(connection.get(), nullptr);
+    {
+        std::lock_guard<std::mutex> lock(connection->writeMutex);
+        close(connection->fd);
+        connection->fd= -1;
+    }
+    connection->readerDone= true;
+}
+
+int AnalysisServer::run() {
+    std::signal(SIGPIPE, SIG_IGN); // A client hanging up must not kill the server
+
+    std::string error;
+    if(!openListener(error)) {
+        std::cerr << "serve: " << error << std::endl;
+        return 1;
+    }
+
+    int workerCount= _options.workers > 0 ? _options.workers : std::max(1u, std::thread::hardware_concurrency());
+    std::shared_ptr<TranspositionTable> sharedTT;
+    if(_options.sharedHash) sharedTT= std::make_shared<TranspositionTable>(_options.hashMB);
+    _workers.resize(workerCount); // Never resized again: worker threads keep references
+    for(auto& worker: _workers) {
+        worker.bot= std::make_unique<Bot>(sharedTT ? sharedTT : std::make_shared<TranspositionTable>(_options.hashMB));
+    }
+    for(auto& worker: _workers) {
+        worker.thread= std::thread(&AnalysisServer::workerLoop, this, std::ref(worker));
+    }
+
+    std::string where= _options.socketPath.empty() ? "127.0.0.1:" + std::to_string(_options.port) : _options.socketPath;
+    std::cout << "serve: listening on " << where << " with " << workerCount << " workers" << std::endl;
+
+    // Poll with a timeout so a shutdown request is noticed without closing the socket under accept()
+    while(!_shutdown) {
+        pollfd listener{_listenFd, POLLIN, 0};
+        int ready= poll(&listener, 1, 200);
+        if(ready <= 0) continue;
+        int fd= accept(_listenFd, nullptr, nullptr);
+        if(fd < 0) continue;
+
+        auto connection= std::make_shared<Connection>();
+        connection->fd= fd;
+        // Reap readers of connections that have already gone away
+        for(auto it= _connections.begin(); it != _connections.end();) {
+            if(it->first->readerDone) {
+                it->second.join();
+                it= _connections.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        _connections.emplace_back(connection, std::thread(&AnalysisServer::serveConnection, this, connection));
+    }
+
+    shutdown();
+    return 0;
+}
+
+void AnalysisServer::shutdown() {
+    _shutdown= true;
+    stopJobs(nullptr, nullptr);
+    _jobsAvailable.notify_all();
+    for(auto& worker: _workers) {
+        if(worker.thread.joinable()) worker.thread.join();
+    }
+
+    for(auto& [connection, thread]: _connections) {
+        {
+            std::lock_guard<std::mutex> lock(connection->writeMutex);
+            if(connection->fd >= 0) ::shutdown(connection->fd, SHUT_RDWR); // Wakes the blocked recv()
+        }
+        if(thread.joinable()) thread.join();
+    }
+    _connections.clear();
+
+    if(_listenFd >= 0) {
+        close(_listenFd);
+        _listenFd= -1;
+        if(!_options.socketPath.empty()) unlink(_options.socketPath.c_str());
+    }
+}
+
+#else
+
+bool AnalysisServer::Connection::send(const std::string&) {
+    return false;
+}
+
+bool AnalysisServer::openListener(std::string& error) {
+    error= "local sockets are not supported on this platform";
+    return false;
+}
+
+void AnalysisServer::serveConnection(std::shared_ptr<Connection>) {}
+
+int AnalysisServer::run() {
+    std::cerr << "serve: local sockets are not supported on this platform" << std::endl;
+    return 1;
+}
+
+void AnalysisServer::shutdown() {}
+
+#endif
+
+} // namespace talawachess
@@ -0,0 +1,189 @@
+#include "Annotator.hpp"
+#include "Bot.hpp"
+#include "Notation.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+namespace talawachess {
+using namespace core::board;
+using namespace core::Piece;
+
+// Mate scores are clamped to this, so a slower mate is not counted as a mistake
+static const int MATE_CLAMP= 10000;
+
+Annotator::Annotator(const AnnotateOptions& options): _options(options) {}
+
+// "[%eval 0.35]" or "[%eval #-3]", from white's point of view
+static std::string evalComment(int score, bool isMate, int mateIn, bool whiteToMove) {
+    std::ostringstream text;
+    text << "[%eval ";
+    if(isMate) {
+        text << "#" << (whiteToMove ? mateIn : -mateIn);
+    } else {
+        text << std::fixed << std::setprecision(2) << (whiteToMove ? score : -score) / 100.0;
+    }
+    text << "]";
+    return text.str();
+}
+
+void Annotator::writeGame(std::ostream& out, const AnnotatedGame& game, int& mistakes, int& blunders) const {
+    for(const auto& tag: game.game.tags) out << "[" << tag.name << " \"" << tag.value << "\"]\n";
+    if(game.game.tag("Annotator").empty()) out << "[Annotator \"talawachess\"]\n";
+    out << "\n";
+
+    // Movetext, wrapped at 80 columns
+    std::string line;
+    auto emit= [&](const std::string& word) {
+        if(!line.empty() && line.size() + 1 + word.size() > 80) {
+            out << line << "\n";
+            line.clear();
+        }
+        line+= (line.empty() ? "" : " ") + word;
+    };
+
+    Board board;
+    board.setFen(game.fen);
+    for(size_t ply= 0; ply < game.moves.size(); ++ply) {
+        const core::Move& move= game.moves[ply];
+        bool whiteToMove= board.activeColor == WHITE;
+
+        const PositionEval& before= game.evals[ply];
+        const PositionEval& after= game.evals[ply + 1];
+        int loss= before.score + after.score; // after.score is the opponent's point of view
+        std::string san= notation::toSan(board, move);
+        std::string best;
+        bool hasBest= !(before.bestMove.from == before.bestMove.to);
+        if(hasBest && loss >= _options.mistakeCp) best= notation::toSan(board, before.bestMove);
+
+        // Every move carries a comment, so black's moves always need their number again
+        emit(std::to_string(board.fullMoveNumber) + (whiteToMove ? ". " : "... ") + san);
+        if(loss >= _options.blunderCp) {
+            emit("$4");
+            blunders++;
+        } else if(loss >= _options.mistakeCp) {
+            emit("$2");
+            mistakes++;
+        }
+        board.makeMove(move);
+
+        if(!after.terminal) {
+            std::string comment= "{" + evalComment(after.score, after.isMate, after.mateIn, board.activeColor == WHITE);
+            if(!best.empty()) comment+= " " + best + " was best";
+            emit(comment + "}");
+        } else if(!best.empty()) {
+            emit("{" + best + " was best}");
+        }
+    }
+    std::string_view result= game.game.tag("Result");
+    emit(result.empty() ? "*" : std::string(result));
+    out << line << "\n\n";
+}
+
+int Annotator::run() {
+    pgn::MappedFile file;
+    std::string error;
+    if(!file.open(_options.inputPath, error)) {
+        std::cerr << "annotate: " << error << std::endl;
+        return 1;
+    }
+
+    pgn::Reader reader(file.text());
+    pgn::Game game;
+    Board board;
+    while(reader.next(game)) {
+        AnnotatedGame annotated;
+        annotated.game= game;
+        annotated.fen= pgn::startFen(game);
+        if(!pgn::replay(game, board, annotated.moves, error)) {
+            std::cerr << "annotate: game " << _games.size() + 1 << ": " << error << ", annotating the moves before it" << std::endl;
+        }
+        annotated.evals.resize(annotated.moves.size() + 1);
+        _games.push_back(std::move(annotated));
+    }
+
+    // One job per position, so a few long games still spread over every core
+    std::vector<std::pair<int, int>> jobs; // (game, ply)
+    for(int g= 0; g < static_cast<int>(_games.size()); ++g) {
+        for(int ply= 0; ply <= static_cast<int>(_games[g].moves.size()); ++ply) jobs.push_back({g, ply});
+    }
+    int threadCount= _options.threads > 0 ? _options.threads : std::max(1u, std::thread::hardware_concurrency());
+    threadCount= std::max(1, std::min<int>(threadCount, jobs.size()));
+    std::cout << "annotate: " << _games.size() << " games, " << jobs.size() << " positions, " << _options.nodes << " nodes each, "
+              << threadCount << " threads" << std::endl;
+
+    std::atomic<size_t> next= 0;
+    std::atomic<size_t> done= 0;
+    auto worker= [&]() {
+        auto bot= std::make_unique<Bot>(std::make_shared<TranspositionTable>(_options.hashMB));
+        SearchInfo lastInfo;
+        bot->setInfoCallback([&lastInfo](const SearchInfo& info) {
+            if(info.multiPV == 1) lastInfo= info;
+        });
+        Board position;
+        MoveList legalMoves;
+        while(true) {
+            size_t index= next++;
+            if(index >= jobs.size()) return;
+            AnnotatedGame& target= _games[jobs[index].first];
+            int ply= jobs[index].second;
+            position.setFen(target.fen);
+            for(int i= 0; i < ply; ++i) position.makeMove(target.moves[i]);
+
+            PositionEval& eval= target.evals[ply];
+            notation::generateLegalMoves(position, legalMoves);
+            if(legalMoves.empty()) {
+                Coordinate king= position.activeColor == WHITE ? position.whiteKingPos : position.blackKingPos;
+                bool mated= MoveGenerator::isSquareAttacked(position, king, position.activeColor == WHITE ? BLACK : WHITE);
+                eval.terminal= true;
+                eval.isMate= mated;
+                eval.score= mated ? -MATE_CLAMP : 0;
+            } else {
+                SearchLimits limits;
+                limits.nodes= _options.nodes;
+                bot->setPosition(position);
+                lastInfo= SearchInfo();
+                auto [move, score]= bot->getBestMove(limits);
+                eval.score= std::clamp(score, -MATE_CLAMP, MATE_CLAMP);
+                eval.isMate= lastInfo.isMate;
+                eval.mateIn= lastInfo.mateIn;
+                eval.bestMove= move;
+            }
+            done++;
+        }
+    };
+
+    auto start= std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for(int i= 0; i < threadCount; ++i) threads.emplace_back(worker);
+    auto nextReport= start + std::chrono::seconds(10);
+    while(done < jobs.size()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if(std::chrono::steady_clock::now() >= nextReport) {
+            std::cout << "annotate: " << done << "/" << jobs.size() << " positions" << std::endl;
+            nextReport+= std::chrono::seconds(10);
+        }
+    }
+    for(auto& thread: threads) thread.join();
+    double seconds= std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::ofstream out(_options.outputPath);
+    if(!out) {
+        std::cerr << "annotate: cannot write " << _options.outputPath << std::endl;
+        return 1;
+    }
+    int mistakes= 0, blunders= 0;
+    for(const auto& annotated: _games) writeGame(out, annotated, mistakes, blunders);
+    std::cout << "annotate: " << jobs.size() << " positions in " << std::fixed << std::setprecision(1) << seconds << "s ("
+              << std::setprecision(0) << jobs.size() / std::max(seconds, 1e-9) << " positions/s), " << mistakes << " mistakes, "
+              << blunders << " blunders, written to " << _options.outputPath << std::endl;
+    return 0;
+}
+
+} // namespace talawachess
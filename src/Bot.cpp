@@ -1,61 +1,243 @@
 #include "Bot.hpp"
 #include "Board.hpp"
 #include "Evaluator.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
+#include <sstream>
+#include <thread>
 namespace talawachess {
 using namespace core::board;
 using namespace core::Piece;
 using namespace core;
 
-Bot::Bot(): _board(),
-            _moveGen(_board) {
-    // Initialize Transposition Table with default size (e.g., 512 MB)
-    resizeTT(512);
+// Search trace hooks (see SearchTrace.hpp). TRACED(reason, value) returns value from searchNode
+// with the reason noted; TRACE_CHILD notes how the next child's depth was adjusted.
+#ifdef TALAWA_TRACE
+#define TRACED(reason, value) (_traceReason= trace::reason, (value))
+#define TRACE_CHILD(ss, reduction, extension) ((ss).traceReduction= (reduction), (ss).traceExtension= (extension))
+#else
+#define TRACED(reason, value) (value)
+#define TRACE_CHILD(ss, reduction, extension) ((void)0)
+#endif
+
+Bot::Bot(): Bot(std::make_shared<TranspositionTable>(DEFAULT_HASH_MB)) {}
+
+Bot::Bot(std::shared_ptr<TranspositionTable> tt): _board(),
+                                                  _moveGen(_board),
+                                                  _tt(std::move(tt)) {
+    clearHistory();
 }
-void Bot::resizeTT(size_t sizeInMB) {
-    // Clear old entries and free their moves first
 
-    size_t numEntries= (sizeInMB * 1024 * 1024) / sizeof(TTEntry);
-    _tt.clear();
-    _tt.resize(numEntries);
-    // Initialize all entries properly
-    for(auto& entry: _tt) {
-        entry.bestMove= core::Move(); // Initialize to default move
-        entry.zobristHash= 0;
-        entry.depth= -1;
-        entry.flag= TT_EXACT;
-        entry.score= -INF;
+Bot::~Bot() {
+    stopHelpers();
+}
+
+void Bot::setThreads(int threads) {
+    stopHelpers();
+    _helpers.clear();
+    for(int i= 1; i < threads; ++i) {
+        _helpers.push_back(std::make_unique<Bot>(_tt));
+        _helpers.back()->_params= _params;
+    }
+}
+
+bool Bot::ttProbe(TTData& data) const {
+    if(!_tt->probe(_board.zobristHash, data)) return false;
+    if(data.score > TT_MATE - 1000) data.score= MATE_VAL - (TT_MATE - data.score);
+    else if(data.score < -TT_MATE + 1000) data.score= -MATE_VAL + (TT_MATE + data.score);
+    return true;
+}
+
+void Bot::ttStore(const core::Move& bestMove, int score, int depth, TTFlag flag) {
+    if(score > MATE_VAL - 1000) score= TT_MATE - (MATE_VAL - score);
+    else if(score < -MATE_VAL + 1000) score= -TT_MATE + (MATE_VAL + score);
+    else score= std::clamp(score, -TT_MATE + 1000, TT_MATE - 1000);
+    _tt->store(_board.zobristHash, bestMove, score, depth, flag);
+}
+
+void Bot::setSearchParams(const SearchParams& params) {
+    _params= params;
+    for(auto& helper: _helpers) helper->_params= params;
+}
+
+// Name table shared by set() and toString()
+static const std::pair<const char*, int SearchParams::*> SEARCH_PARAM_FIELDS[]= {
+    {"rfpMargin", &SearchParams::rfpMargin},
+    {"rfpMaxDepth", &SearchParams::rfpMaxDepth},
+    {"deltaMargin", &SearchParams::deltaMargin},
+    {"nullMoveBase", &SearchParams::nullMoveBase},
+    {"nullMoveDivisor", &SearchParams::nullMoveDivisor},
+    {"lmrMinMove", &SearchParams::lmrMinMove},
+    {"lmrDepthDivisor", &SearchParams::lmrDepthDivisor},
+    {"lmrMoveDivisor", &SearchParams::lmrMoveDivisor},
+    {"singularMinDepth", &SearchParams::singularMinDepth},
+};
+
+bool SearchParams::set(const std::string& name, int value) {
+    for(const auto& [fieldName, field]: SEARCH_PARAM_FIELDS) {
+        if(name != fieldName) continue;
+        if((field == &SearchParams::nullMoveDivisor || field == &SearchParams::lmrDepthDivisor ||
+            field == &SearchParams::lmrMoveDivisor) &&
+           value <= 0) {
+            return false; // Divisors must stay positive
+        }
+        this->*field= value;
+        return true;
+    }
+    return false;
+}
+
+bool SearchParams::parse(const std::string& text, std::string& error) {
+    std::istringstream ss(text);
+    std::string entry;
+    while(std::getline(ss, entry, ',')) {
+        if(entry.empty()) continue;
+        size_t eq= entry.find('=');
+        bool ok= eq != std::string::npos;
+        if(ok) {
+            try {
+                ok= set(entry.substr(0, eq), std::stoi(entry.substr(eq + 1)));
+            } catch(const std::exception&) {
+                ok= false;
+            }
+        }
+        if(!ok) {
+            error= "bad search parameter '" + entry + "'";
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string SearchParams::toString() const {
+    std::string text;
+    for(const auto& [fieldName, field]: SEARCH_PARAM_FIELDS) {
+        if(!text.empty()) text+= ",";
+        text+= std::string(fieldName) + "=" + std::to_string(this->*field);
+    }
+    return text;
+}
+
+bool Bot::setHashSize(size_t sizeInMB, std::string& error) {
+    if(_tt->isShared()) {
+        error= "the table is shared and keeps its size of " + std::to_string(_tt->sizeInMB()) + " MB";
+        return false;
+    }
+    _tt->resize(sizeInMB);
+    return true;
+}
+
+bool Bot::clearSharedHash(std::string& error) {
+    if(_tt->clear(static_cast<int>(_helpers.size()) + 1)) return true;
+    error= "only the process that created the shared table may clear it";
+    return false;
+}
+
+bool Bot::setSharedHash(const std::string& name, std::string& error) {
+    if(name.empty()) {
+        if(_tt->isShared()) _tt->resize(_tt->sizeInMB());
+        return true;
     }
+    return _tt->attachShared(name, _tt->sizeInMB(), error);
 }
 
-void Bot::clearTT() {
-    for(auto& entry: _tt) {
-        entry.bestMove= core::Move(); // Initialize to default move
-        entry.zobristHash= 0;
-        entry.depth= -1;
-        entry.flag= TT_EXACT;
-        entry.score= -INF;
+bool Bot::setHashFile(const std::string& path, std::string& error) {
+    if(path.empty()) {
+        if(_tt->isShared()) _tt->resize(_tt->sizeInMB());
+        return true;
     }
+    return _tt->attachFile(path, _tt->sizeInMB(), error);
+}
+
+bool Bot::setTraceFile(const std::string& path, std::string& error) {
+#ifdef TALAWA_TRACE
+    if(path.empty()) {
+        _trace.reset();
+        return true;
+    }
+    auto recorder= std::make_unique<trace::Recorder>();
+    if(!recorder->open(path, error)) return false;
+    _trace= std::move(recorder);
+    return true;
+#else
+    (void)path;
+    error= "not compiled in, configure with -DTALAWA_TRACE=ON";
+    return false;
+#endif
+}
+
+// Index of a piece in the 12-entry continuation history tables (white pieces first)
+static int historyPieceIndex(core::Piece::Piece piece) {
+    return (core::Piece::GetPieceType(piece) - 1) + (core::Piece::IsColor(piece, core::Piece::BLACK) ? 6 : 0);
 }
 
-void Bot::clearKillers() {
-    for(int i= 0; i < MAX_PLY; ++i) {
-        _killers[i][0]= core::Move();
-        _killers[i][1]= core::Move();
+void Bot::clearStack() {
+    for(auto& entry: _stack) {
+        entry= SearchStack();
     }
 }
 
+void Bot::clearHistory() {
+    for(auto& side: _history)
+        for(auto& from: side)
+            for(auto& value: from) value= 0;
+    _continuationHistory.assign(12 * 64, PieceToHistory{});
+}
+
 void Bot::updateKillers(const core::Move& move, int ply) {
     if(ply >= MAX_PLY) return;
     // Don't store captures or promotions as killers (they're already ordered high)
     if(move.captured != core::Piece::NONE) return;
     if(move.promotion != core::Piece::NONE) return;
+    core::Move* killers= stackAt(ply).killers;
     // Don't store if it's already the first killer
-    if(_killers[ply][0].from == move.from && _killers[ply][0].to == move.to) return;
+    if(killers[0].from == move.from && killers[0].to == move.to) return;
     // Shift killer 0 to killer 1, store new killer in slot 0
-    _killers[ply][1]= _killers[ply][0];
-    _killers[ply][0]= move;
+    killers[1]= killers[0];
+    killers[0]= move;
+}
+
+// Gravity update: keeps every entry inside [-HISTORY_MAX, HISTORY_MAX]
+static void applyHistoryBonus(int16_t& entry, int bonus, int maxValue) {
+    entry+= bonus - entry * std::abs(bonus) / maxValue;
+}
+
+int Bot::quietHistoryScore(const core::Move& move, int ply) const {
+    int side= core::Piece::IsColor(move.movedPiece, core::Piece::WHITE) ? 0 : 1;
+    int piece= historyPieceIndex(move.movedPiece);
+    int to= move.to.ToIndex();
+    int score= _history[side][move.from.ToIndex()][to];
+    // Continuation history of the moves one and two plies back
+    for(int back= 1; back <= 2; ++back) {
+        const PieceToHistory* cont= _stack[ply + STACK_OFFSET - back].continuationHistory;
+        if(cont != nullptr) score+= (*cont)[piece][to];
+    }
+    return score;
 }
+
+void Bot::updateQuietStats(const core::Move& move, int ply, int depth, const core::Move* quietsTried, int quietCount) {
+    updateKillers(move, ply);
+
+    int bonus= std::min(depth * depth * 16, 1200);
+    auto update= [&](const core::Move& m, int value) {
+        int side= core::Piece::IsColor(m.movedPiece, core::Piece::WHITE) ? 0 : 1;
+        int piece= historyPieceIndex(m.movedPiece);
+        int to= m.to.ToIndex();
+        applyHistoryBonus(_history[side][m.from.ToIndex()][to], value, HISTORY_MAX);
+        for(int back= 1; back <= 2; ++back) {
+            PieceToHistory* cont= _stack[ply + STACK_OFFSET - back].continuationHistory;
+            if(cont != nullptr) applyHistoryBonus((*cont)[piece][to], value, HISTORY_MAX);
+        }
+    };
+    update(move, bonus);
+    // Quiet moves searched before the cutoff move did not cut: push them down
+    for(int i= 0; i < quietCount; ++i) {
+        update(quietsTried[i], -bonus);
+    }
+}
+
 void Bot::setFen(const std::string& fen) {
     _board.setFen(fen);
 }
@@ -97,43 +279,79 @@ void Bot::orderMoves(MoveList& moves, const core::Move* ttMove, int ply) const {
             int promoType= core::Piece::GetPieceType(move.promotion);
             move.score= 1000000 + evaluator::PieceValues[promoType];
         }
-        // 4. Killer Moves (quiet moves that caused cutoffs at this ply)
+        // 4. Killer Moves (quiet moves that caused cutoffs at this ply), then history
         // Only apply in main search (ply >= 0), not in quiescence (ply = -1)
         else if(ply >= 0 && ply < MAX_PLY) {
-            if(_killers[ply][0].from == move.from && _killers[ply][0].to == move.to) {
+            const core::Move* killers= _stack[ply + STACK_OFFSET].killers;
+            if(killers[0].from == move.from && killers[0].to == move.to) {
                 move.score= 900000; // First killer - below all captures
-            } else if(_killers[ply][1].from == move.from && _killers[ply][1].to == move.to) {
+            } else if(killers[1].from == move.from && killers[1].to == move.to) {
                 move.score= 800000; // Second killer
+            } else {
+                move.score= quietHistoryScore(move, ply); // Bounded well below the killers
             }
         }
     }
 
     // Sort descending by score
+    TALAWA_PROFILE_ZONE(SORT_MOVES);
     std::sort(moves.begin(), moves.end(), [](const core::Move& a, const core::Move& b) {
         return a.score > b.score;
     });
 }
+#ifdef TALAWA_TRACE
 int Bot::search(int depth, int ply, int alpha, int beta) {
+    if(!_trace) return searchNode(depth, ply, alpha, beta);
+    uint64_t hash= _board.zobristHash;
+    bool verification= stackAt(ply).excludedMove.from != stackAt(ply).excludedMove.to;
+    int score= searchNode(depth, ply, alpha, beta);
+
+    const SearchStack& parent= stackAt(ply - 1);
+    trace::Record record= {};
+    record.hash= hash;
+    record.alpha= alpha;
+    record.beta= beta;
+    record.score= score;
+    record.move= trace::encodeMove(parent.currentMove);
+    record.ply= static_cast<uint8_t>(ply);
+    record.depth= static_cast<int8_t>(std::clamp(depth, -128, 127));
+    record.reduction= verification ? 0 : parent.traceReduction;
+    record.extension= verification ? 0 : parent.traceExtension;
+    record.reason= _stopSearch ? trace::STOPPED : _traceReason;
+    record.iteration= static_cast<uint8_t>(_traceIteration);
+    record.flags= verification ? trace::FLAG_VERIFICATION : 0;
+    _trace->record(record);
+    return score;
+}
+#endif
+
+int Bot::searchNode(int depth, int ply, int alpha, int beta) {
     using namespace talawachess::core::Piece;
     using namespace talawachess::core::board;
 
     // 1. Check for time limit every 512 nodes (more responsive to stop command)
-    if((positionsEvaluated & 511) == 0) {
+    if((_nodes.load(std::memory_order_relaxed) & 511) == 0) {
         checkTime();
     }
 
     // 2. Don't search if we've been signaled to stop
-    if(_stopSearch) return 0;
+    if(_stopSearch) return TRACED(STOPPED, 0);
+    // A frontier node is counted and probed once, by quiescence (see the hand-off below)
+    bool frontier= depth <= 0;
+    if(!frontier) {
+        countNode();
+        _stats.nodes++;
+    }
+    stackAt(ply).pvLength= 0;
 
-    // 3. Prevent search explosions
-    const int MAX_PLY= 100; // Define a safe maximum depth
-    if(ply >= MAX_PLY) {
+    // 3. Prevent search explosions: the search stack ends at MAX_PLY
+    if(ply >= MAX_PLY - 1) {
         // Evaluate immediately to break the infinite loop
-        return bot::evaluator::evaluate(_board); // Or call quiesce(alpha, beta, ply);
+        return TRACED(MAX_DEPTH, bot::evaluator::evaluate(_board));
     }
     // 4. CRITICAL: Draw Detection (Repetition & 50-Move Rule)
     if(ply > 0) {
-        if(_board.halfMoveClock >= 100) return 0; // 50-move rule
+        if(_board.halfMoveClock >= 100) return TRACED(DRAW, 0); // 50-move rule
 
         // 1-Fold Repetition Detection
         int limit= _board.game_history.size() - _board.halfMoveClock;
@@ -142,49 +360,93 @@ int Bot::search(int depth, int ply, int alpha, int beta) {
         // Step back by 2 to check positions where it was the same side's turn to move
         for(int i= _board.game_history.size() - 2; i >= limit; i-= 2) {
             if(_board.game_history[i].zobristHash == _board.zobristHash) {
-                return 0; // Instant cutoff: We are in a looping check sequence
+                return TRACED(DRAW, 0); // Instant cutoff: We are in a looping check sequence
             }
         }
     }
 
-    TTEntry& ttEntry= _tt[_board.zobristHash % _tt.size()];
-    bool ttHit= (ttEntry.zobristHash == _board.zobristHash);
-    core::Move* ttBestMove= nullptr;
+    if(frontier) return TRACED(QSEARCH, quiesce(alpha, beta, ply));
+
+    SearchStack& ss= stackAt(ply);
+    const core::Move excludedMove= ss.excludedMove;
+    bool excluding= excludedMove.from != excludedMove.to;
+
+    TTData ttEntry;
+    bool ttHit= ttProbe(ttEntry);
+    _stats.ttProbes++;
+    const core::Move* ttBestMove= nullptr;
     if(ttHit) {
+        _stats.ttHits++;
         ttBestMove= &ttEntry.bestMove;
-        if(ttEntry.depth >= depth) {
+        // A verification search with an excluded move must not trust the full-width result
+        if(ttEntry.depth >= depth && !excluding) {
             int score= ttEntry.score;
 
             if(score > MATE_VAL - 100) score-= ply; // Adjust mate scores for distance
             else if(score < -MATE_VAL + 100) score+= ply;
 
-            if(ttEntry.flag == TT_EXACT) return score;
-            if(ttEntry.flag == TT_ALPHA && score <= alpha) return alpha;
-            if(ttEntry.flag == TT_BETA && score >= beta) return beta;
+            if(ttEntry.flag == TT_EXACT || (ttEntry.flag == TT_ALPHA && score <= alpha) || (ttEntry.flag == TT_BETA && score >= beta)) {
+                _stats.ttCutoffs++;
+            }
+            if(ttEntry.flag == TT_EXACT) return TRACED(TT_CUTOFF, score);
+            if(ttEntry.flag == TT_ALPHA && score <= alpha) return TRACED(TT_CUTOFF, alpha);
+            if(ttEntry.flag == TT_BETA && score >= beta) return TRACED(TT_CUTOFF, beta);
         }
     }
 
-    if(depth == 0) return quiesce(alpha, beta, ply);
+    // 5. Static evaluation and the improving flag (kept from the first visit when excluding)
+    bool inCheck= isInCheck();
+    if(!excluding) {
+        ss.inCheck= inCheck;
+        ss.staticEval= inCheck ? -INF : bot::evaluator::evaluate(_board);
+        const SearchStack& twoPliesAgo= stackAt(ply - 2);
+        ss.improving= !inCheck && (twoPliesAgo.inCheck || ply < 2 || ss.staticEval > twoPliesAgo.staticEval);
+    }
+    stackAt(ply + 1).killers[0]= core::Move();
+    stackAt(ply + 1).killers[1]= core::Move();
+    bool mateBounds= beta >= MATE_VAL - 100 || beta <= -MATE_VAL + 100;
+
+    // Reverse Futility Pruning: far above beta at low depth, trust the static eval
+    if(!inCheck && !excluding && ply > 0 && depth <= _params.rfpMaxDepth && !mateBounds && beta - alpha == 1 &&
+       ss.staticEval - _params.rfpMargin * (depth - ss.improving) >= beta) {
+        return TRACED(RFP, beta);
+    }
 
     // Null Move Pruning
-    // Skip when: at root, in check, or beta is a mate score
-    if(depth >= 3 && ply > 0 && beta < MATE_VAL - 100 && beta > -MATE_VAL + 100) {
-        // Verify the side to move is not in check
-        Coordinate ourKingPos= (_board.activeColor == Color::WHITE) ? _board.whiteKingPos : _board.blackKingPos;
-        Color opponentColor= (_board.activeColor == Color::WHITE) ? Color::BLACK : Color::WHITE;
-        if(!MoveGenerator::isSquareAttacked(_board, ourKingPos, opponentColor)) {
-            int R= 2 + depth / 6;
-            _board.makeNullMove();
-            int nullScore= -search(depth - 1 - R, ply + 1, -beta, -beta + 1);
-            _board.undoNullMove();
-
-            if(_stopSearch) return 0;
-            if(nullScore >= beta) {
-                return beta;
-            }
+    // Skip when: at root, in check, excluding a move, static eval below beta or beta is a mate score
+    if(depth >= 3 && ply > 0 && !inCheck && !excluding && !mateBounds && ss.staticEval >= beta) {
+        int R= _params.nullMoveBase + depth / _params.nullMoveDivisor;
+        _stats.nullMoveTries++;
+        ss.currentMove= core::Move();
+        ss.continuationHistory= nullptr;
+        _board.makeNullMove();
+        _tt->prefetch(_board.zobristHash);
+        TRACE_CHILD(ss, R, 0);
+        int nullScore= -search(depth - 1 - R, ply + 1, -beta, -beta + 1);
+        _board.undoNullMove();
+
+        if(_stopSearch) return TRACED(STOPPED, 0);
+        if(nullScore >= beta) {
+            _stats.nullMoveCutoffs++;
+            return TRACED(NULL_MOVE, beta);
         }
     }
 
+    // Singular Extension: if every alternative to the TT move fails well below its score,
+    // the TT move is forced and gets searched one ply deeper.
+    core::Move singularMove;
+    if(depth >= _params.singularMinDepth && ply > 0 && !excluding && ttHit && ttBestMove->from != ttBestMove->to &&
+       ttEntry.flag != TT_ALPHA && ttEntry.depth >= depth - 3 &&
+       ttEntry.score < MATE_VAL - 100 && ttEntry.score > -MATE_VAL + 100) {
+        core::Move ttMoveCopy= *ttBestMove;
+        int singularBeta= ttEntry.score - 2 * depth;
+        ss.excludedMove= ttMoveCopy;
+        int value= search((depth - 1) / 2, ply, singularBeta - 1, singularBeta);
+        ss.excludedMove= core::Move();
+        if(_stopSearch) return TRACED(STOPPED, 0);
+        if(value < singularBeta) singularMove= ttMoveCopy;
+    }
+
     MoveList moveList;
     _moveGen.generateMoves(moveList);
 
@@ -192,15 +454,15 @@ int Bot::search(int depth, int ply, int alpha, int beta) {
     int originalAlpha= alpha;
     core::Move bestMoveThisNode;
 
-    Coordinate myKingPos= (_board.activeColor == Piece::WHITE) ? _board.whiteKingPos : _board.blackKingPos;
-    Piece::Color oppColor= (_board.activeColor == Piece::WHITE) ? Piece::BLACK : Piece::WHITE;
-    bool inCheck= MoveGenerator::isSquareAttacked(_board, myKingPos, oppColor);
-
+    core::Move quietsTried[64];
+    int quietCount= 0;
     int legalMoveCount= 0; // Count of legal moves for statistics
     for(int i= 0; i < moveList.count; ++i) {
         auto& move= moveList.moves[i];
-        auto side= _board.activeColor;
+        if(excluding && move.from == excludedMove.from && move.to == excludedMove.to && move.promotion == excludedMove.promotion) continue;
+
         _board.makeMove(move);
+        _tt->prefetch(_board.zobristHash); // The child probes this bucket first thing
 
         // Deferred Legality Check:
         if(!MoveGenerator::IsLegalPosition(_board)) {
@@ -208,6 +470,8 @@ int Bot::search(int depth, int ply, int alpha, int beta) {
             continue;          // Skip to next move
         }
         legalMoveCount++;
+        ss.currentMove= move;
+        ss.continuationHistory= &_continuationHistory[historyPieceIndex(move.movedPiece) * 64 + move.to.ToIndex()];
 
         // Check extension: if we give check, extend depth by 1
         int extension= 0;
@@ -220,263 +484,738 @@ int Bot::search(int depth, int ply, int alpha, int beta) {
                 extension= 1;
             }
         }
+        if(extension == 0 && move.from == singularMove.from && move.to == singularMove.to && move.promotion == singularMove.promotion) {
+            extension= 1;
+        }
 
         // Late Move Reduction:
-        bool isKiller= false;
-        if(ply >= 0 && ply < MAX_PLY) {
-            if(_killers[ply][0].from == move.from && _killers[ply][0].to == move.to) isKiller= true;
-            if(_killers[ply][1].from == move.from && _killers[ply][1].to == move.to) isKiller= true;
-        }
+        bool isQuiet= move.captured == Piece::NONE && move.promotion == Piece::NONE;
+        bool isKiller= (ss.killers[0].from == move.from && ss.killers[0].to == move.to) ||
+                       (ss.killers[1].from == move.from && ss.killers[1].to == move.to);
 
         int reduction= 0;
-        if(depth >= 3 && i >= 3 && !inCheck && !isKiller && extension == 0 && move.captured == Piece::NONE && move.promotion == Piece::NONE) {
+        if(depth >= 3 && i >= _params.lmrMinMove && !inCheck && !isKiller && extension == 0 && isQuiet) {
             // Base reduction of 1, plus scaling based on depth and move index
-            reduction= 1 + (depth / 4) + (i / 8);
+            reduction= 1 + (depth / _params.lmrDepthDivisor) + (i / _params.lmrMoveDivisor);
+            // Positions that are getting worse are less likely to hide a good late move
+            if(!ss.improving) reduction++;
 
             // Safety cap: Never reduce the depth to 0 or below, always search at least depth 1
             if(reduction >= depth) {
                 reduction= depth - 1;
             }
+            if(reduction > 0) _stats.lmrReductions++;
         }
 
+        TRACE_CHILD(ss, reduction, extension);
         int evaluation= -search(depth - 1 + extension - reduction, ply + 1, -beta, -alpha);
 
         // If we reduced and the move looks better than alpha, research at full depth (Late Move Reduction with Research)
         if(evaluation > alpha && reduction > 0) {
+            _stats.lmrResearches++;
+            TRACE_CHILD(ss, 0, extension);
             evaluation= -search(depth - 1 + extension, ply + 1, -beta, -alpha);
         }
         _board.undoMove();
 
-        if(_stopSearch) return 0; // If we were signaled to stop during the search, return immediately
+        if(_stopSearch) return TRACED(STOPPED, 0); // If we were signaled to stop during the search, return immediately
         if(evaluation >= beta) {
-            // Update killer moves for quiet moves that cause beta cutoff
-            updateKillers(move, ply);
+            _stats.failHighs++;
+            if(legalMoveCount == 1) _stats.failHighsFirst++;
+            // Reward quiet moves that cause a beta cutoff (killers and history)
+            if(isQuiet) updateQuietStats(move, ply, depth, quietsTried, quietCount);
 
             int storedScore= evaluation;
             if(storedScore > MATE_VAL - 100) storedScore+= ply;
             else if(storedScore < -MATE_VAL + 100) storedScore-= ply;
 
-            if(ttEntry.zobristHash != _board.zobristHash || depth >= ttEntry.depth) {
-                ttEntry.zobristHash= _board.zobristHash;
-                ttEntry.bestMove= move;
-                ttEntry.score= storedScore;
-                ttEntry.depth= depth;
-                ttEntry.flag= TT_BETA;
+            // Re-read the slot: other threads and our own subtree may have replaced it
+            TTData slot;
+            bool sameKey= ttProbe(slot);
+            if(!excluding && (!sameKey || depth >= slot.depth)) {
+                ttStore(move, storedScore, depth, TT_BETA);
             }
-            return beta; // Fail hard beta cutoff
+            return TRACED(BETA_CUTOFF, beta); // Fail hard beta cutoff
         }
+        if(isQuiet && quietCount < 64) quietsTried[quietCount++]= move;
         if(evaluation > alpha) {
             alpha= evaluation;
             bestMoveThisNode= move;
+            updatePV(ply, move);
         }
     }
 
     if(legalMoveCount == 0) {
+        // Only the excluded move is legal: that says nothing about mate
+        if(excluding) return TRACED(SEARCHED, alpha);
         // No legal moves found (all moves were illegal due to checks)
-        auto attackerColor= _board.activeColor == Color::WHITE ? Color::BLACK : Color::WHITE;
-        auto kingPos= _board.activeColor == Color::WHITE ? _board.whiteKingPos : _board.blackKingPos;
-        if(MoveGenerator::isSquareAttacked(_board, kingPos, attackerColor)) {
-            checkMatesFound++;
-            return -MATE_VAL + ply; // Checkmate, prefer faster mates
+        if(inCheck) {
+            _stats.mates++;
+            return TRACED(MATE, -MATE_VAL + ply); // Checkmate, prefer faster mates
         } else {
-            return 0; // Stalemate
+            return TRACED(STALEMATE, 0); // Stalemate
         }
     }
+    if(excluding) return TRACED(SEARCHED, alpha);
+
     int storedScore= alpha;
     if(storedScore > MATE_VAL - 100) storedScore+= ply;
     else if(storedScore < -MATE_VAL + 100) storedScore-= ply;
 
-    if(ttEntry.zobristHash != _board.zobristHash || depth >= ttEntry.depth) {
+    TTData slot;
+    bool sameKey= ttProbe(slot);
+    if(!sameKey || depth >= slot.depth) {
 
         // CRITICAL: Preserve the old best move if we failed low (Alpha node)
+        core::Move storedMove; // New position: no move
         if(alpha > originalAlpha) {
-            ttEntry.bestMove= bestMoveThisNode; // Exact node: we found a new best move
-        } else if(ttEntry.zobristHash != _board.zobristHash) {
-            ttEntry.bestMove= core::Move(); // New position: clear the move
+            storedMove= bestMoveThisNode; // Exact node: we found a new best move
+        } else if(sameKey) {
+            storedMove= slot.bestMove; // Same position but failed low: keep the old best move
         }
-        // If it was the same position but failed low, we leave ttEntry.bestMove untouched!
-
-        ttEntry.zobristHash= _board.zobristHash;
-        ttEntry.score= storedScore;
-        ttEntry.depth= depth;
-        ttEntry.flag= (alpha > originalAlpha) ? TT_EXACT : TT_ALPHA;
+        ttStore(storedMove, storedScore, depth, (alpha > originalAlpha) ? TT_EXACT : TT_ALPHA);
     }
 
-    return alpha;
+    return TRACED(SEARCHED, alpha);
 }
 
-int Bot::quiesce(int alpha, int beta, int ply) {
-    // Generate legal moves to check for checkmate/stalemate
+int Bot::quiesce(int alpha, int beta, int ply, int qsDepth) {
+    if((_nodes.load(std::memory_order_relaxed) & 511) == 0) {
+        checkTime();
+    }
+    if(_stopSearch) return 0;
+    countNode();
+    _stats.qnodes++;
+    if(ply >= MAX_PLY) return bot::evaluator::evaluate(_board);
+    stackAt(ply).pvLength= 0;
+
+    // 1. Transposition Table: every stored entry has depth >= 0, which is all quiescence needs
+    TTData ttEntry;
+    bool ttHit= ttProbe(ttEntry);
+    _stats.ttProbes++;
+    const core::Move* ttBestMove= nullptr;
+    if(ttHit && ttEntry.depth >= 0) {
+        _stats.ttHits++;
+        int score= ttEntry.score;
+        if(score > MATE_VAL - 100) score-= ply;
+        else if(score < -MATE_VAL + 100) score+= ply;
+
+        if(ttEntry.flag == TT_EXACT || (ttEntry.flag == TT_ALPHA && score <= alpha) || (ttEntry.flag == TT_BETA && score >= beta)) {
+            _stats.ttCutoffs++;
+        }
+        if(ttEntry.flag == TT_EXACT) return score;
+        if(ttEntry.flag == TT_ALPHA && score <= alpha) return alpha;
+        if(ttEntry.flag == TT_BETA && score >= beta) return beta;
+        if(ttEntry.bestMove.from != ttEntry.bestMove.to) ttBestMove= &ttEntry.bestMove;
+    }
+
+    bool inCheck= isInCheck();
+    int originalAlpha= alpha;
+
+    // 2. Stand Pat: Assumes we can just "stop" and not capture anything if our position is good.
+    // Not allowed when in check - every evasion has to be searched instead.
+    int standPat= -INF;
+    if(!inCheck) {
+        standPat= bot::evaluator::evaluate(_board);
+        if(standPat >= beta) return beta;
+        if(alpha < standPat) alpha= standPat;
+    }
+
     MoveList moves;
     _moveGen.generateMoves(moves);
+    orderMoves(moves, ttBestMove, -1); // Order captures by MVV-LVA, no killers in quiescence
+
+    core::Move bestMoveThisNode;
+    int legalMoveCount= 0;
+    for(const auto& move: moves) {
+        bool isTactical= move.captured != core::Piece::NONE || move.promotion != core::Piece::NONE;
 
-    // 1. Stand Pat: Assumes we can just "stop" and not capture anything if our position is good
-    int stand_pat= bot::evaluator::evaluate(_board);
-    positionsEvaluated++;
-    if(stand_pat >= beta) return beta;
-    if(alpha < stand_pat) alpha= stand_pat;
+        if(!inCheck) {
+            // Only quiet checks at the first quiescence ply are allowed besides captures/promotions
+            if(!isTactical && !(_qsearchChecks && qsDepth == 0)) continue;
 
-    // 2. Search only Captures and Promotions
-    orderMoves(moves, nullptr, -1); // Order captures by MVV-LVA, no killers in quiescence
+            if(isTactical && move.promotion == core::Piece::NONE) {
+                // Delta Pruning: even winning the victim for free cannot raise alpha
+                int victimValue= bot::evaluator::PieceValues[core::Piece::GetPieceType(move.captured)];
+                if(standPat + victimValue + _params.deltaMargin <= alpha) continue;
 
-    int legalMoveCount= 0; // Count of legal moves for statistics
-    for(const auto& move: moves) {
-        // FILTER: Only look at Captures and Promotions
-        if(move.captured == core::Piece::NONE && move.promotion == core::Piece::NONE) continue;
+                // SEE Pruning: skip captures that lose material in the exchange
+                if(see(move) < 0) continue;
+            }
+        }
 
-        auto side= _board.activeColor;
         _board.makeMove(move);
+        _tt->prefetch(_board.zobristHash);
 
         // Deferred Legality Check:
         if(!MoveGenerator::IsLegalPosition(_board)) {
             _board.undoMove(); // Illegal move, undo it
             continue;          // Skip to next move
         }
+
+        // A quiet move is only worth searching here if it gives check
+        if(!inCheck && !isTactical && !isInCheck()) {
+            _board.undoMove();
+            continue;
+        }
         legalMoveCount++;
-        int score= -quiesce(-beta, -alpha, ply + 1);
+
+        int score= -quiesce(-beta, -alpha, ply + 1, qsDepth + 1);
         _board.undoMove();
 
-        if(score >= beta) return beta;
-        if(score > alpha) alpha= score;
+        if(_stopSearch) return 0;
+        if(score >= beta) {
+            int storedScore= score;
+            if(storedScore > MATE_VAL - 100) storedScore+= ply;
+            else if(storedScore < -MATE_VAL + 100) storedScore-= ply;
+
+            TTData slot;
+            ttProbe(slot);
+            if(slot.depth <= 0) {
+                ttStore(move, storedScore, 0, TT_BETA);
+            }
+            return beta;
+        }
+        if(score > alpha) {
+            alpha= score;
+            bestMoveThisNode= move;
+        }
     }
-    if(legalMoveCount == 0) {
-        // No legal moves found (all moves were illegal due to checks)
-        auto attackerColor= _board.activeColor == Color::WHITE ? Color::BLACK : Color::WHITE;
-        auto kingPos= _board.activeColor == Color::WHITE ? _board.whiteKingPos : _board.blackKingPos;
-        if(MoveGenerator::isSquareAttacked(_board, kingPos, attackerColor)) {
-            checkMatesFound++;
-            return -MATE_VAL + ply; // Checkmate, prefer faster mates
-        } else {
-            return 0; // Stalemate
+
+    // Only an evasion search proves mate; running out of captures is just a quiet position
+    if(inCheck && legalMoveCount == 0) {
+        _stats.mates++;
+        return -MATE_VAL + ply;
+    }
+
+    // Deep entries from the main search are never overwritten by quiescence results
+    TTData slot;
+    bool sameKey= ttProbe(slot);
+    if(slot.depth <= 0) {
+        int storedScore= alpha;
+        if(storedScore > MATE_VAL - 100) storedScore+= ply;
+        else if(storedScore < -MATE_VAL + 100) storedScore-= ply;
+
+        core::Move storedMove;
+        if(alpha > originalAlpha) {
+            storedMove= bestMoveThisNode;
+        } else if(sameKey) {
+            storedMove= slot.bestMove;
         }
+        ttStore(storedMove, storedScore, 0, (alpha > originalAlpha) ? TT_EXACT : TT_ALPHA);
     }
     return alpha;
 }
 
-std::pair<core::Move, int> Bot::getBestMove(int timeLimitMs, int maxDepth) {
-    checkMatesFound= 0;    // Reset checkmate counter for this search
-    positionsEvaluated= 0; // Reset positions evaluated counter for this search
-    clearKillers();        // Clear killer moves for new search
+bool Bot::isInCheck() const {
+    Coordinate kingPos= (_board.activeColor == Piece::WHITE) ? _board.whiteKingPos : _board.blackKingPos;
+    Piece::Color oppColor= (_board.activeColor == Piece::WHITE) ? Piece::BLACK : Piece::WHITE;
+    return MoveGenerator::isSquareAttacked(_board, kingPos, oppColor);
+}
+
+// Returns the square of the cheapest piece of 'side' attacking 'target' on the given squares, or -1.
+// Works on a scratch copy of the board so pieces removed during an exchange reveal x-ray attackers.
+static int leastValuableAttacker(const Piece::Piece* squares, Coordinate target, Piece::Color side) {
+    int bestSquare= -1;
+    int bestValue= INT32_MAX;
+    auto consider= [&](int square) {
+        int value= bot::evaluator::PieceValues[GetPieceType(squares[square])];
+        if(value < bestValue) {
+            bestValue= value;
+            bestSquare= square;
+        }
+    };
+
+    int pawnRankDir= (side == Piece::WHITE) ? -1 : 1;
+    for(int fileOffset: {-1, 1}) {
+        Coordinate from(target.file + fileOffset, target.rank + pawnRankDir);
+        if(!from.IsValid()) continue;
+        Piece::Piece p= squares[from.ToIndex()];
+        if(p != Piece::NONE && IsColor(p, side) && IsType(p, Piece::PAWN)) return from.ToIndex(); // Nothing is cheaper
+    }
+    for(const auto& dir: MoveGenerator::KNIGHT_DIRS) {
+        Coordinate from= target + dir;
+        if(!from.IsValid()) continue;
+        Piece::Piece p= squares[from.ToIndex()];
+        if(p != Piece::NONE && IsColor(p, side) && IsType(p, Piece::KNIGHT)) consider(from.ToIndex());
+    }
+    for(const auto& dir: MoveGenerator::QUEEN_DIRS) {
+        bool diagonal= dir.file != 0 && dir.rank != 0;
+        Coordinate from= target + dir;
+        int distance= 1;
+        while(from.IsValid()) {
+            Piece::Piece p= squares[from.ToIndex()];
+            if(p != Piece::NONE) {
+                if(IsColor(p, side)) {
+                    if(IsType(p, Piece::QUEEN) ||
+                       (diagonal && IsType(p, Piece::BISHOP)) ||
+                       (!diagonal && IsType(p, Piece::ROOK)) ||
+                       (distance == 1 && IsType(p, Piece::KING))) {
+                        consider(from.ToIndex());
+                    }
+                }
+                break; // Blocked
+            }
+            from= from + dir;
+            distance++;
+        }
+    }
+    return bestSquare;
+}
 
-    startTimer(timeLimitMs); // Start the timer as we are about to begin searching
+// Static Exchange Evaluation: material balance (for the mover) of the capture sequence on move.to,
+// where both sides always recapture with their least valuable attacker and may stop at any time.
+int Bot::see(const core::Move& move) const {
+    using bot::evaluator::PieceValues;
+    Piece::Piece squares[64];
+    std::copy(std::begin(_board.squares), std::end(_board.squares), squares);
 
-    // If no depth limit specified, use a high default
-    int depthLimit= (maxDepth > 0) ? maxDepth : 64;
+    int toIdx= move.to.ToIndex();
+    int gain[32];
+    int d= 0;
 
-    core::Move bestMove;
-    int bestScore= -INF;
-    int depthReached= 0;
+    gain[0]= PieceValues[GetPieceType(move.captured)];
+    if(squares[toIdx] == Piece::NONE && move.captured != Piece::NONE) {
+        squares[Coordinate(move.to.file, move.from.rank).ToIndex()]= Piece::NONE; // En passant
+    }
+    Piece::Piece occupant= move.promotion != Piece::NONE ? move.promotion : move.movedPiece;
+    if(move.promotion != Piece::NONE) gain[0]+= PieceValues[GetPieceType(move.promotion)] - PieceValues[Piece::PAWN];
+    squares[move.from.ToIndex()]= Piece::NONE;
+    squares[toIdx]= occupant;
+
+    Piece::Color side= (GetColor(move.movedPiece) == Piece::WHITE) ? Piece::BLACK : Piece::WHITE;
+    while(d < 31) {
+        int attacker= leastValuableAttacker(squares, move.to, side);
+        if(attacker < 0) break;
+        d++;
+        gain[d]= PieceValues[GetPieceType(squares[toIdx])] - gain[d - 1];
+        if(std::max(-gain[d - 1], gain[d]) < 0) break; // Neither side can improve by continuing
+        squares[toIdx]= squares[attacker];
+        squares[attacker]= Piece::NONE;
+        side= (side == Piece::WHITE) ? Piece::BLACK : Piece::WHITE;
+    }
+    while(d > 0) {
+        gain[d - 1]= -std::max(-gain[d - 1], gain[d]);
+        d--;
+    }
+    return gain[0];
+}
 
-    for(int depth= 1; depth <= depthLimit; ++depth) { // Iterative deepening
-        MoveList moves;
-        _moveGen.generateMoves(moves);
+// PV of this ply = move followed by the PV of the child node
+void Bot::updatePV(int ply, const core::Move& move) {
+    SearchStack& ss= stackAt(ply);
+    const SearchStack& child= stackAt(ply + 1);
+    ss.pv[0]= move;
+    int length= std::min(child.pvLength, MAX_PLY - 1);
+    std::copy(child.pv, child.pv + length, ss.pv + 1);
+    ss.pvLength= length + 1;
+}
 
-        TTEntry& ttEntry= _tt[_board.zobristHash % _tt.size()];
-        core::Move* ttMove= (ttEntry.zobristHash == _board.zobristHash) ? &ttEntry.bestMove : nullptr;
-        orderMoves(moves, ttMove, 0); // Move ordering for better alpha-beta performance
+void Bot::initRootMoves() {
+    _rootMoves.clear();
+    MoveList moves;
+    _moveGen.generateMoves(moves);
 
-        // Reset best for this depth - each depth should find its own best move
-        core::Move bestMoveThisDepth;
-        int bestScoreThisDepth= -INF;
-        int alpha= -INF;
-        int legalMoveCount= 0; // Count of legal moves for statistics
-        for(const auto& move: moves) {
-            _board.makeMove(move);
+    TTData ttEntry;
+    const core::Move* ttMove= ttProbe(ttEntry) ? &ttEntry.bestMove : nullptr;
+    orderMoves(moves, ttMove, 0); // Initial order; later iterations sort by search results
 
-            // Deferred Legality Check:
-            if(!MoveGenerator::IsLegalPosition(_board)) {
-                _board.undoMove(); // Illegal move, undo it
-                continue;          // Skip to next move
-            }
-            legalMoveCount++;
-            int score= -search(depth - 1, 1, -INF, -alpha);
-            _board.undoMove();
+    for(const auto& move: moves) {
+        _board.makeMove(move);
+        bool legal= MoveGenerator::IsLegalPosition(_board);
+        _board.undoMove();
+        if(legal) _rootMoves.emplace_back(move, -INF);
+    }
+}
 
-            if(_stopSearch) break; // If we were signaled to stop during the search, break out of move loop
+// One iteration over the root moves at the given depth. Returns the index of the best move,
+// or -1 if none beat -INF; when the search was stopped, the iteration is incomplete.
+int Bot::searchRoot(int depth) {
+    SearchStack& rootStack= stackAt(0);
+    for(auto& rootMove: _rootMoves) {
+        rootMove.previousScore= rootMove.score;
+        rootMove.score= -INF;
+    }
 
-            if(score > bestScoreThisDepth) {
-                bestScoreThisDepth= score;
-                bestMoveThisDepth= move;
-            }
-            if(score > alpha) {
-                alpha= score;
-            }
+    // In MultiPV mode the window stays open until the MultiPV-th best score is known,
+    // so the top lines all get exact scores
+    int alpha= -INF;
+    int bestIndex= -1;
+    std::vector<int> topScores; // Best scores of this iteration, descending, at most _multiPV
+    for(int i= 0; i < static_cast<int>(_rootMoves.size()); ++i) {
+        RootMove& rootMove= _rootMoves[i];
+        const core::Move& move= rootMove.move;
+        uint64_t nodesBefore= _nodes;
+        _board.makeMove(move);
+        rootStack.currentMove= move;
+        rootStack.continuationHistory= &_continuationHistory[historyPieceIndex(move.movedPiece) * 64 + move.to.ToIndex()];
+        int score= -search(depth - 1, 1, -INF, -alpha);
+        _board.undoMove();
+        rootMove.nodes+= _nodes - nodesBefore;
+
+        if(_stopSearch) break; // If we were signaled to stop during the search, break out of move loop
+
+        if(score > alpha) {
+            if(bestIndex < 0 || score > _rootMoves[bestIndex].score) bestIndex= i;
+            topScores.insert(std::upper_bound(topScores.begin(), topScores.end(), score, std::greater<int>()), score);
+            if(static_cast<int>(topScores.size()) > _multiPV) topScores.pop_back();
+            if(static_cast<int>(topScores.size()) == _multiPV) alpha= topScores.back();
+            rootMove.score= score;
+            updatePV(0, move);
+            rootMove.pv.assign(rootStack.pv, rootStack.pv + rootStack.pvLength);
+        } else {
+            // Failed low: the score is only an upper bound equal to alpha, useless for ordering
+            rootMove.pv.assign(1, move);
         }
+    }
+    return bestIndex;
+}
+
+// Best move first; moves that failed low are ordered by their score in the previous
+// iteration, then by how much effort refuting them took
+void Bot::sortRootMoves() {
+    std::stable_sort(_rootMoves.begin(), _rootMoves.end(), [](const RootMove& a, const RootMove& b) {
+        if(a.score != b.score) return a.score > b.score;
+        // Both failed low: a move that held a better score last iteration is the likelier
+        // alternative, then the one that took more effort to refute
+        if(a.previousScore != b.previousScore) return a.previousScore > b.previousScore;
+        return a.nodes > b.nodes;
+    });
+}
+
+void Bot::printInfo(int depth, int score, const std::vector<core::Move>& pv, int multiPV) {
+    SearchInfo info;
+    info.depth= depth;
+    info.multiPV= multiPV;
+    info.timeMs= getElapsedTimeMs();
+    info.nodes= totalNodes();
+    info.nps= info.timeMs > 0 ? (info.nodes * 1000ULL / info.timeMs) : info.nodes;
+    info.hashfull= _tt->hashfull();
+    info.pv= pv;
+    // UCI scores are always from side-to-move's perspective
+    if(score > MATE_VAL - 100) {
+        // Side to move is delivering mate
+        int pliesToMate= MATE_VAL - score;
+        info.isMate= true;
+        info.mateIn= (pliesToMate + 1) / 2;
+    } else if(score < -MATE_VAL + 100) {
+        // Side to move is getting mated
+        int pliesToMate= score + MATE_VAL;
+        info.isMate= true;
+        info.mateIn= -((pliesToMate + 1) / 2);
+    } else {
+        info.score= score;
+    }
+    reportInfo(info);
+}
+
+void Bot::reportInfo(const SearchInfo& info) {
+    if(_infoCallback) {
+        _infoCallback(info);
+        return;
+    }
+    // One write per line: the UCI thread may print "readyok" concurrently
+    std::cout << toUciInfo(info) + "\n" << std::flush;
+}
+
+std::string toUciInfo(const SearchInfo& info) {
+    std::ostringstream line;
+    line << "info depth " << info.depth << " multipv " << info.multiPV;
+    if(info.isMate) {
+        line << " score mate " << info.mateIn;
+    } else {
+        line << " score cp " << info.score;
+    }
+    line << " time " << info.timeMs << " nodes " << info.nodes << " nps " << info.nps << " hashfull " << info.hashfull << " pv";
+    for(const auto& move: info.pv) line << " " << move.ToString();
+    return line.str();
+}
+
+uint64_t Bot::totalNodes() const {
+    uint64_t nodes= _nodes;
+    for(const auto& helper: _helpers) nodes+= helper->_nodes;
+    return nodes;
+}
+
+SearchReport Bot::getSearchReport() const {
+    SearchReport report;
+    report.totals= _stats;
+    for(const auto& helper: _helpers) report.totals+= helper->_stats;
+    for(size_t i= 0; i < _iterationNodes.size(); ++i) {
+        report.iterationNodes.push_back(_iterationNodes[i] - (i > 0 ? _iterationNodes[i - 1] : 0));
+    }
+    report.threads= static_cast<int>(_helpers.size()) + 1;
+    report.timeMs= getElapsedTimeMs();
+    report.hashfull= _tt->hashfull();
+    return report;
+}
+
+// Helpers search the same root position with their own board copy; their only output is
+// what they leave in the shared TT and their last completed iteration (for the vote).
+void Bot::startHelpers(int depthLimit) {
+    for(int i= 0; i < static_cast<int>(_helpers.size()); ++i) {
+        Bot& helper= *_helpers[i];
+        helper._board= _board;
+        helper.clearStack();
+        helper.startTimer(0); // The main thread decides when everybody stops
+        helper._pondering= false;
+        helper._stopSearch= false;
+        helper._completedDepth= 0;
+        helper.initRootMoves();
+        _helperThreads.emplace_back(&Bot::helperSearch, &helper, depthLimit, i + 1);
+    }
+}
+
+void Bot::stopHelpers() {
+    for(auto& helper: _helpers) helper->_stopSearch= true;
+    for(auto& thread: _helperThreads) thread.join();
+    _helperThreads.clear();
+}
+
+void Bot::helperSearch(int depthLimit, int threadIndex) {
+    TALAWA_PROFILE_ZONE(SEARCH);
+    // Depth skipping spreads the helpers over different iterations instead of all of them
+    // searching the same depth in lockstep with the main thread
+    static const int SKIP_SIZE[20]= {1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4};
+    static const int SKIP_PHASE[20]= {0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7};
+    int skip= (threadIndex - 1) % 20;
+
+    // Different first-iteration root order, so early cutoffs (and TT contents) differ per thread
+    if(_rootMoves.size() > 1) {
+        std::rotate(_rootMoves.begin(), _rootMoves.begin() + threadIndex % _rootMoves.size(), _rootMoves.end());
+    }
 
-        if(legalMoveCount == 0) {
+    SearchStack& rootStack= stackAt(0);
+    rootStack.inCheck= isInCheck();
+    rootStack.staticEval= rootStack.inCheck ? -INF : bot::evaluator::evaluate(_board);
+
+    for(int depth= 1; depth <= depthLimit && !_stopSearch; ++depth) {
+        if(((depth + SKIP_PHASE[skip]) / SKIP_SIZE[skip]) % 2 != 0) continue;
+        searchRoot(depth);
+        if(_stopSearch) break;
+        sortRootMoves();
+        _completedBest= _rootMoves.front();
+        _completedDepth= depth;
+    }
+}
 
-            // We are at the root and found no legal moves - this means the position is either checkmate or stalemate and we should return and say error because there is no best move
-            std::cout << "info" << " depth " << depth << " score " << "cp 0" << " time " << getElapsedTimeMs() << " nodes " << positionsEvaluated << " nps 0 pv" << std::endl;
-            return {core::Move(), 0};
+// Every thread votes for its best move, weighted by its completed depth and by how far its
+// score is above the worst thread's. Proven mates overrule the vote.
+const Bot* Bot::voteBestThread() const {
+    std::vector<const Bot*> threads{this};
+    for(const auto& helper: _helpers) {
+        if(helper->_completedDepth > 0) threads.push_back(helper.get());
+    }
+
+    int minScore= INF;
+    for(const Bot* thread: threads) minScore= std::min(minScore, thread->_completedBest.score);
+
+    std::vector<std::pair<core::Move, int64_t>> votes;
+    auto votesFor= [&votes](const core::Move& move) -> int64_t& {
+        for(auto& vote: votes) {
+            if(vote.first.from == move.from && vote.first.to == move.to && vote.first.promotion == move.promotion) return vote.second;
         }
+        votes.emplace_back(move, 0);
+        return votes.back().second;
+    };
+    for(const Bot* thread: threads) {
+        votesFor(thread->_completedBest.move)+= static_cast<int64_t>(thread->_completedBest.score - minScore + 14) * thread->_completedDepth;
+    }
+
+    const Bot* best= this;
+    for(const Bot* thread: threads) {
+        int bestScore= best->_completedBest.score;
+        int score= thread->_completedBest.score;
+        if(bestScore > MATE_VAL - 100 || bestScore < -MATE_VAL + 100) {
+            if(score > bestScore) best= thread; // Shorter mate, or getting mated later
+        } else if(score > MATE_VAL - 100 || votesFor(thread->_completedBest.move) > votesFor(best->_completedBest.move)) {
+            best= thread;
+        }
+    }
+    return best;
+}
+
+std::pair<core::Move, int> Bot::getBestMove(const SearchLimits& limits) {
+    TALAWA_PROFILE_ZONE(SEARCH);
+    _nodes= 0;
+    _stats= SearchStats();
+    _iterationNodes.clear();
+    for(auto& helper: _helpers) { // Also when there is nothing to search and they never start
+        helper->_nodes= 0;
+        helper->_stats= SearchStats();
+    }
+    clearStack(); // Clear killer moves and per-ply state for new search
+
+    _timeManager.init(limits, _board.activeColor, _moveOverheadMs);
+    startTimer(_timeManager.hardLimitMs()); // Start the timer as we are about to begin searching
+    _nodeLimit= limits.nodes;
+    _tt->newSearch();
+    // Ponder state armed by setPondering before the search started; a ponderhit may have cleared it already
+    _telemetry.beginSearch(_pondering ? 0 : _timeLimitMs);
+    _ponderMove= core::Move();
+
+    // If no depth limit specified, use a high default
+    int depthLimit= (limits.depth > 0) ? std::min(limits.depth, MAX_PLY) : MAX_PLY;
+
+    core::Move bestMove;
+    int bestScore= -INF;
+    int depthReached= 0;
+    _completedDepth= 0;
+    _completedBest= RootMove(core::Move(), -INF);
+    _completedBest.pv.clear();
+
+    SearchStack& rootStack= stackAt(0);
+    rootStack.inCheck= isInCheck();
+    rootStack.staticEval= rootStack.inCheck ? -INF : bot::evaluator::evaluate(_board);
+
+    initRootMoves();
+    if(_rootMoves.empty()) {
+        // We are at the root and found no legal moves - this means the position is either checkmate or stalemate and we should return and say error because there is no best move
+        SearchInfo info;
+        info.isMate= rootStack.inCheck;
+        info.timeMs= getElapsedTimeMs();
+        reportInfo(info);
+        _stopSearch= false;
+        _pondering= false;
+        return {core::Move(), 0};
+    }
+#ifdef TALAWA_TRACE
+    if(_trace) {
+        trace::Record start= {};
+        start.hash= _board.zobristHash;
+        start.depth= static_cast<int8_t>(depthLimit);
+        start.reason= trace::SEARCH_START;
+        _trace->record(start);
+    }
+#endif
+    startHelpers(depthLimit);
 
-        if(_stopSearch) break; // If we were signaled to stop during the search, break out of depth loop
+    for(int depth= 1; depth <= depthLimit; ++depth) { // Iterative deepening
+#ifdef TALAWA_TRACE
+        _traceIteration= depth;
+#endif
+        int bestIndexThisDepth= searchRoot(depth);
+
+        if(_stopSearch) {
+            // Keep the useful part of an interrupted iteration: a move that completed at this
+            // depth and beat the previous best's new score is a better choice than the old best.
+            if(bestIndexThisDepth > 0) {
+                bestMove= _rootMoves[bestIndexThisDepth].move;
+                bestScore= _rootMoves[bestIndexThisDepth].score;
+                _completedBest= _rootMoves[bestIndexThisDepth];
+            }
+            break; // If we were signaled to stop during the search, break out of depth loop
+        }
+        core::Move previousBest= bestMove;
+        sortRootMoves();
 
         // Update overall best from this completed depth
-        bestMove= bestMoveThisDepth;
-        bestScore= bestScoreThisDepth;
+        RootMove& best= _rootMoves.front();
+        completePV(best.pv, depth);
+        bestMove= best.move;
+        bestScore= best.score;
         depthReached= depth;
-
-        // printing
-
-        auto elapsedMs= getElapsedTimeMs();
-        // Output search info for GUI
-        std::string pvLine= extractPV(bestMove, depthReached);
-        std::string scoreStr;
-        // UCI scores are always from side-to-move's perspective
-        if(bestScore > MATE_VAL - 100) {
-            // Side to move is delivering mate
-            int pliesToMate= MATE_VAL - bestScore;
-            int movesToMate= (pliesToMate + 1) / 2;
-            scoreStr= "mate " + std::to_string(movesToMate);
-        } else if(bestScore < -MATE_VAL + 100) {
-            // Side to move is getting mated
-            int pliesToMate= bestScore + MATE_VAL;
-            int movesToMate= (pliesToMate + 1) / 2;
-            scoreStr= "mate -" + std::to_string(movesToMate);
-        } else {
-            scoreStr= "cp " + std::to_string(bestScore);
+        _completedBest= best;
+        _completedDepth= depth;
+        _iterationNodes.push_back(totalNodes());
+
+        printInfo(depthReached, bestScore, best.pv);
+        // Further lines in MultiPV mode: only the top moves have exact scores
+        for(int line= 1; line < std::min<int>(_multiPV, _rootMoves.size()); ++line) {
+            RootMove& rootMove= _rootMoves[line];
+            if(rootMove.score == -INF) break;
+            completePV(rootMove.pv, depth);
+            printInfo(depthReached, rootMove.score, rootMove.pv, line + 1);
         }
 
-        uint64_t nps= elapsedMs > 0 ? (positionsEvaluated * 1000ULL / elapsedMs) : positionsEvaluated;
-        std::cout << "info" << " depth " << depthReached << " score " << scoreStr << " time " << elapsedMs << " nodes " << positionsEvaluated << " nps " << nps << " pv" << pvLine << std::endl;
+        // Soft time limit: stop between iterations once the search looks settled
+        bool bestMoveChanged= depth == 1 || !(previousBest.from == bestMove.from && previousBest.to == bestMove.to);
+        double bestMoveNodeFraction= _nodes > 0 ? static_cast<double>(best.nodes) / _nodes : 1.0;
+        checkTime(); // Picks up a ponderhit that arrived during this iteration
+        bool softStop= _timeManager.shouldStop(getClockElapsedMs(), bestMoveChanged, bestScore, bestMoveNodeFraction);
+        if(softStop && !_pondering) break;
     }
+
+    // While pondering, the best move may only be sent after "ponderhit" or "stop"
+    while(_pondering && !_stopSearch) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    _pondering= false;
+    stopHelpers();
+#ifdef TALAWA_TRACE
+    if(_trace) _trace->flush();
+#endif
+
+    // Stopped before depth 1 finished: still answer with a legal move, the first in move order
+    if(bestMove.from == bestMove.to) {
+        const RootMove& first= _rootMoves.front();
+        bestMove= first.move;
+        bestScore= first.score > -INF ? first.score : bot::evaluator::evaluate(_board);
+        _completedBest= RootMove(bestMove, bestScore);
+    }
+
+    std::vector<core::Move> bestPv= _completedBest.pv;
+    if(!_helpers.empty() && _completedDepth > 0) {
+        const Bot* chosen= voteBestThread();
+        if(chosen != this) {
+            bestMove= chosen->_completedBest.move;
+            bestScore= chosen->_completedBest.score;
+            bestPv= chosen->_completedBest.pv;
+            printInfo(chosen->_completedDepth, bestScore, bestPv);
+        }
+    }
+
+    updatePonderMove(bestPv);
+    _stopSearch= false;
     return {bestMove, bestScore};
 }
 
-std::string Bot::extractPV(const core::Move& bestMove, int depth) {
-    std::string pv= " " + bestMove.ToString();
-    std::vector<core::Move> movesMade;
-
-    // Make the first move (the one we already found)
-    _board.makeMove(bestMove);
-    movesMade.push_back(bestMove);
+// The ponder move is the reply predicted by the PV of the move we play
+void Bot::updatePonderMove(std::vector<core::Move> pv) {
+    _ponderMove= core::Move();
+    if(pv.empty()) return;
+    if(pv.size() < 2) completePV(pv, 2);
+    if(pv.size() >= 2) _ponderMove= pv[1];
+}
 
-    // Follow the TT for the rest of the PV
-    for(int i= 1; i < depth; ++i) {
-        TTEntry& ttEntry= _tt[_board.zobristHash % _tt.size()];
-        if(ttEntry.zobristHash != _board.zobristHash) break;
+// Extends a PV that was cut short (e.g. by a TT cutoff) with the TT's best moves
+void Bot::completePV(std::vector<core::Move>& pv, int depth) {
+    int movesMade= 0;
+    for(const auto& move: pv) {
+        _board.makeMove(move);
+        movesMade++;
+    }
 
-        core::Move& move= ttEntry.bestMove;
-        if(move.from == move.to) break; // Invalid move
+    while(static_cast<int>(pv.size()) < depth) {
+        TTData ttEntry;
+        if(!ttProbe(ttEntry)) break;
+        const core::Move& ttMove= ttEntry.bestMove;
+        if(ttMove.from == ttMove.to) break; // No move stored
 
-        // Verify move is legal
-        auto attackerColor= _board.activeColor == core::Piece::WHITE ? core::Piece::BLACK : core::Piece::WHITE;
-        auto kingPos= _board.activeColor == core::Piece::WHITE ? _board.whiteKingPos : _board.blackKingPos;
-        if(MoveGenerator::isSquareAttacked(_board, kingPos, attackerColor)) {
-            break; // Current position is in check, so any move in TT is suspect, break PV extraction
+        // Only follow the TT move if it is legal here (protects against hash collisions)
+        MoveList moves;
+        _moveGen.generateMoves(moves);
+        const core::Move* found= nullptr;
+        for(const auto& move: moves) {
+            if(move.from == ttMove.from && move.to == ttMove.to && move.promotion == ttMove.promotion) {
+                found= &move;
+                break;
+            }
         }
-
-        pv+= " " + move.ToString();
+        if(found == nullptr) break;
+        core::Move move= *found;
         _board.makeMove(move);
-        movesMade.push_back(move);
+        if(!MoveGenerator::IsLegalPosition(_board)) {
+            _board.undoMove();
+            break;
+        }
+        pv.push_back(move);
+        movesMade++;
     }
 
     // Undo all moves to restore board state
-    for(int i= movesMade.size() - 1; i >= 0; --i) {
+    for(int i= 0; i < movesMade; ++i) {
         _board.undoMove();
     }
-
-    return pv;
 }
 } // namespace talawachess
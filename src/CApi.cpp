@@ -0,0 +1,126 @@
+// C bindings (talawachess.h). No exception may cross into C code, so every entry point that
+// allocates catches them.
+#include "Engine.hpp"
+#include "talawachess.h"
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+using namespace talawachess;
+
+struct talawa_engine {
+    Engine engine;
+    explicit talawa_engine(const EngineOptions& options): engine(options) {}
+};
+
+static void copyText(const std::string& text, char* buffer, size_t size) {
+    if(buffer == nullptr || size == 0) return;
+    size_t length= std::min(text.size(), size - 1);
+    std::memcpy(buffer, text.data(), length);
+    buffer[length]= '\0';
+}
+
+static std::string moveText(const core::Move& move) {
+    return move.from == move.to ? "" : move.ToString();
+}
+
+extern "C" {
+
+talawa_engine* talawa_engine_create(size_t hash_mb, int threads) {
+    try {
+        EngineOptions options;
+        options.hashMB= hash_mb > 0 ? hash_mb : options.hashMB;
+        options.threads= threads;
+        return new talawa_engine(options);
+    } catch(...) {
+        return nullptr;
+    }
+}
+
+void talawa_engine_destroy(talawa_engine* engine) {
+    delete engine;
+}
+
+int talawa_engine_set_position(talawa_engine* engine, const char* fen, const char* moves, char* error, size_t error_size) {
+    try {
+        std::vector<std::string> moveList;
+        std::istringstream ss(moves != nullptr ? moves : "");
+        std::string move;
+        while(ss >> move) moveList.push_back(move);
+        std::string message;
+        if(engine->engine.setPosition(fen != nullptr ? fen : "startpos", moveList, message)) return 0;
+        copyText(message, error, error_size);
+    } catch(const std::exception& e) {
+        copyText(e.what(), error, error_size);
+    }
+    return -1;
+}
+
+void talawa_engine_new_game(talawa_engine* engine) {
+    engine->engine.newGame();
+}
+
+void talawa_engine_set_multipv(talawa_engine* engine, int lines) {
+    engine->engine.setMultiPV(lines);
+}
+
+int talawa_engine_search(talawa_engine* engine, const talawa_limits* limits, talawa_info_callback on_info, void* user_data,
+                         talawa_result* result) {
+    try {
+        SearchLimits searchLimits;
+        if(limits != nullptr) {
+            searchLimits.depth= limits->depth;
+            searchLimits.movetime= limits->movetime_ms;
+            searchLimits.nodes= limits->nodes;
+            searchLimits.wtime= limits->wtime_ms;
+            searchLimits.btime= limits->btime_ms;
+            searchLimits.winc= limits->winc_ms;
+            searchLimits.binc= limits->binc_ms;
+            searchLimits.movestogo= limits->movestogo;
+            searchLimits.infinite= limits->infinite != 0;
+        }
+        InfoCallback callback;
+        if(on_info != nullptr) {
+            callback= [on_info, user_data](const SearchInfo& info) {
+                std::string pv;
+                for(const auto& move: info.pv) {
+                    if(!pv.empty()) pv+= ' ';
+                    pv+= move.ToString();
+                }
+                talawa_info out= {};
+                out.depth= info.depth;
+                out.multipv= info.multiPV;
+                out.score_cp= info.score;
+                out.is_mate= info.isMate;
+                out.mate_in= info.mateIn;
+                out.time_ms= info.timeMs;
+                out.nodes= info.nodes;
+                out.nps= info.nps;
+                out.hashfull= info.hashfull;
+                out.pv= pv.c_str();
+                on_info(&out, user_data);
+            };
+        }
+        SearchResult searchResult= engine->engine.search(searchLimits, callback);
+        if(result != nullptr) {
+            *result= {};
+            copyText(moveText(searchResult.bestMove), result->best_move, sizeof(result->best_move));
+            copyText(moveText(searchResult.ponderMove), result->ponder_move, sizeof(result->ponder_move));
+            result->score_cp= searchResult.score;
+            result->is_mate= searchResult.isMate;
+            result->mate_in= searchResult.mateIn;
+            result->depth= searchResult.depth;
+            result->nodes= searchResult.nodes;
+            result->time_ms= searchResult.timeMs;
+        }
+        return 0;
+    } catch(...) {
+        return -1;
+    }
+}
+
+void talawa_engine_stop(talawa_engine* engine) {
+    engine->engine.stop();
+}
+
+} // extern "C"
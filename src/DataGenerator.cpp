@@ -0,0 +1,138 @@
+#include "DataGenerator.hpp"
+#include "Notation.hpp"
+#include "SelfPlay.hpp"
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace talawachess {
+using namespace core::board;
+using namespace core::Piece;
+
+DataGenerator::DataGenerator(const DataGenOptions& options): _options(options) {}
+
+// Scores beyond this are mate scores and say nothing about the evaluation
+static const int MAX_RECORDED_SCORE= 10000;
+
+void DataGenerator::playGame(Bot& bot, std::mt19937_64& rng, std::vector<data::PackedPosition>& records) const {
+    records.clear();
+    Board board;
+    board.setFen(Board::STARTING_POS);
+    bot.setFen(Board::STARTING_POS);
+    bot.resetHeuristics();
+    auto play= [&](const core::Move& move) {
+        board.makeMove(move);
+        bot.performMove(move.ToString());
+    };
+
+    // Random opening; a game that is already over is thrown away
+    MoveList legalMoves;
+    for(int ply= 0; ply < _options.randomPlies; ++ply) {
+        notation::generateLegalMoves(board, legalMoves);
+        if(legalMoves.empty()) return;
+        play(legalMoves[std::uniform_int_distribution<int>(0, legalMoves.size() - 1)(rng)]);
+    }
+
+    SearchLimits limits;
+    limits.depth= _options.depth;
+    limits.nodes= _options.depth > 0 ? 0 : _options.nodes;
+
+    int result= 1; // Draw unless decided otherwise
+    int adjudicateCount= 0;
+    int lastWinner= 0; // +1 white, -1 black: side the adjudication counter is running for
+    for(int ply= 0;; ++ply) {
+        notation::generateLegalMoves(board, legalMoves);
+        bool whiteToMove= board.activeColor == WHITE;
+        Coordinate king= whiteToMove ? board.whiteKingPos : board.blackKingPos;
+        bool inCheck= MoveGenerator::isSquareAttacked(board, king, whiteToMove ? BLACK : WHITE);
+        if(legalMoves.empty()) {
+            if(inCheck) result= whiteToMove ? 0 : 2;
+            break;
+        }
+        if(isDrawByRule(board) || ply >= _options.maxPlies) break;
+
+        auto [move, score]= bot.getBestMove(limits);
+        int whiteScore= whiteToMove ? score : -score;
+        if(ply == 0 && std::abs(whiteScore) > _options.maxOpeningScore) {
+            records.clear(); // Unbalanced opening
+            return;
+        }
+
+        // Only quiet positions: no check to resolve and no capture or promotion to come
+        bool quiet= !inCheck && move.captured == NONE && move.promotion == NONE;
+        if(quiet && std::abs(whiteScore) < MAX_RECORDED_SCORE) records.push_back(data::pack(board, whiteScore, 1));
+
+        // Decisive only while the same side stays winning: a swing starts the count over
+        int winner= whiteScore >= _options.adjudicateScore ? 1 : (whiteScore <= -_options.adjudicateScore ? -1 : 0);
+        adjudicateCount= (winner != 0 && winner == lastWinner) ? adjudicateCount + 1 : (winner != 0 ? 1 : 0);
+        lastWinner= winner;
+        if(adjudicateCount >= 4) {
+            result= winner > 0 ? 2 : 0;
+            break;
+        }
+        play(move);
+    }
+    for(auto& record: records) record.result= result;
+}
+
+int DataGenerator::run() {
+    data::DataWriter writer;
+    std::string error;
+    if(!writer.open(_options.outputPath, error)) {
+        std::cerr << "datagen: " << error << std::endl;
+        return 1;
+    }
+    int threadCount= _options.threads > 0 ? _options.threads : std::max(1u, std::thread::hardware_concurrency());
+    uint64_t seed= _options.seed != 0 ? _options.seed : std::random_device()();
+    std::cout << "datagen: " << _options.positions << " positions to " << _options.outputPath << ", " << threadCount << " threads, "
+              << (_options.depth > 0 ? "depth " + std::to_string(_options.depth) : std::to_string(_options.nodes) + " nodes")
+              << " per move, seed " << seed << std::endl;
+
+    std::atomic<uint64_t> written= 0;
+    std::atomic<uint64_t> games= 0;
+    std::atomic<int> running= threadCount;
+    std::mutex writerMutex;
+    auto worker= [&](int index) {
+        auto bot= std::make_unique<Bot>(std::make_shared<TranspositionTable>(_options.hashMB));
+        bot->setInfoCallback([](const SearchInfo&) {});
+        std::mt19937_64 rng(seed + index * 0x9E3779B97F4A7C15ULL);
+        std::vector<data::PackedPosition> records;
+        while(written < _options.positions) {
+            playGame(*bot, rng, records);
+            if(records.empty()) continue;
+            std::lock_guard<std::mutex> lock(writerMutex);
+            writer.write(records.data(), records.size());
+            written+= records.size();
+            games++;
+        }
+        running--;
+    };
+
+    auto start= std::chrono::steady_clock::now();
+    auto report= [&]() {
+        double seconds= std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double perSecond= seconds > 0 ? written / seconds : 0;
+        std::cout << "datagen: " << written << " positions, " << games << " games, " << std::fixed << std::setprecision(0) << perSecond
+                  << " pos/s, " << perSecond / threadCount << " pos/s per core" << std::defaultfloat << std::endl;
+    };
+    std::vector<std::thread> threads;
+    for(int i= 0; i < threadCount; ++i) threads.emplace_back(worker, i);
+    auto nextReport= start + std::chrono::seconds(10);
+    while(running > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if(std::chrono::steady_clock::now() >= nextReport) {
+            report();
+            nextReport+= std::chrono::seconds(10);
+        }
+    }
+    for(auto& thread: threads) thread.join();
+    writer.close();
+    report();
+    return 0;
+}
+
+} // namespace talawachess
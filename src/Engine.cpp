@@ -0,0 +1,107 @@
+#include "Engine.hpp"
+#include "Notation.hpp"
+
+namespace talawachess {
+using namespace core::board;
+
+Engine::Engine(const EngineOptions& options): _bot(std::make_unique<Bot>(std::make_shared<TranspositionTable>(options.hashMB))) {
+    _bot->setThreads(std::max(1, options.threads));
+    _bot->prefaultHash();
+}
+
+Engine::~Engine() {
+    stop();
+    std::lock_guard<std::mutex> lock(_mutex); // A search still running on another thread returns first
+}
+
+bool Engine::setPosition(const std::string& fen, const std::vector<std::string>& moves, std::string& error) {
+    std::string startFen= fen == "startpos" ? Board::STARTING_POS : fen;
+    if(!notation::validateFen(startFen, error)) return false;
+    Board board;
+    board.setFen(startFen);
+    for(const auto& text: moves) {
+        core::Move move;
+        if(!notation::parseMove(board, text, move)) {
+            error= "illegal move " + text;
+            return false;
+        }
+        board.makeMove(move);
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    _bot->setPosition(board);
+    return true;
+}
+
+void Engine::newGame() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _bot->clearHash();
+    _bot->resetHeuristics();
+}
+
+void Engine::setMultiPV(int lines) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _bot->setMultiPV(lines);
+}
+
+bool Engine::setHashSize(size_t sizeInMB, std::string& error) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    bool resized= _bot->setHashSize(sizeInMB, error);
+    _bot->prefaultHash();
+    return resized;
+}
+
+void Engine::setThreads(int threads) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _bot->setThreads(std::max(1, threads));
+}
+
+SearchResult Engine::search(const SearchLimits& limits, const InfoCallback& onInfo) {
+    {
+        std::lock_guard<std::mutex> stopLock(_stopMutex);
+        _searchesInProgress++; // From here on a stop() is meant for this search
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    SearchResult result;
+    _bot->setInfoCallback([&](const SearchInfo& info) {
+        if(info.multiPV == 1) {
+            result.isMate= info.isMate;
+            result.mateIn= info.mateIn;
+            result.depth= info.depth;
+        }
+        if(onInfo) onInfo(info);
+    });
+    {
+        std::lock_guard<std::mutex> stopLock(_stopMutex);
+        _bot->clearStop(); // Left over from the previous search
+        if(_stopPending) _bot->stopSearch();
+        _bot->setPondering(limits.ponder);
+    }
+    auto [move, score]= _bot->getBestMove(limits);
+    _bot->setInfoCallback(nullptr);
+    {
+        std::lock_guard<std::mutex> stopLock(_stopMutex);
+        _stopPending= false; // Consumed by this search
+        _searchesInProgress--;
+    }
+
+    result.bestMove= move;
+    result.ponderMove= _bot->getPonderMove();
+    result.score= score;
+    result.nodes= _bot->totalNodes();
+    result.timeMs= _bot->getSearchReport().timeMs;
+    return result;
+}
+
+void Engine::stop() {
+    std::lock_guard<std::mutex> stopLock(_stopMutex);
+    if(_searchesInProgress == 0) return; // Late for a search that already returned
+    _stopPending= true;
+    _bot->stopSearch();
+}
+
+void Engine::ponderhit() {
+    std::lock_guard<std::mutex> stopLock(_stopMutex); // Not lost to search() arming the ponder state
+    _bot->ponderhit();
+}
+
+} // namespace talawachess
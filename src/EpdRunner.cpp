@@ -0,0 +1,259 @@
+#include "EpdRunner.hpp"
+#include "Notation.hpp"
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace talawachess {
+using namespace core::board;
+
+EpdRunner::EpdRunner(const EpdOptions& options): _options(options) {}
+
+static bool sameMove(const core::Move& a, const core::Move& b) {
+    return a.from == b.from && a.to == b.to && a.promotion == b.promotion;
+}
+
+// CSV field (RFC 4180): quoted, with quotes doubled, when it holds a separator, quote or newline
+static std::string csvField(const std::string& text) {
+    if(text.find_first_of(",\"\r\n") == std::string::npos) return text;
+    std::string quoted= "\"";
+    for(char c: text) {
+        if(c == '"') quoted+= '"';
+        quoted+= c;
+    }
+    return quoted + "\"";
+}
+
+// One EPD record: the four FEN fields, then "opcode operands;" operations, e.g.
+//   r1bqkb1r/pppp1ppp/2n2n2/4p2Q/2B1P3/8/PPPP1PPP/RNB1K1NR w KQkq - bm Qxf7#; id "scholar";
+bool EpdRunner::parseLine(const std::string& line, int lineNumber, Position& position, std::string& error) {
+    std::istringstream ss(line);
+    std::string fields[4];
+    for(auto& field: fields) {
+        if(!(ss >> field)) {
+            error= "line " + std::to_string(lineNumber) + ": incomplete position";
+            return false;
+        }
+    }
+    std::string operations;
+    std::getline(ss, operations);
+
+    std::string halfMoves= "0", fullMoves= "1";
+    std::vector<std::string> bm, am;
+
+    // Split into operations on ';' outside of quoted operands
+    std::vector<std::string> ops;
+    std::string current;
+    bool quoted= false;
+    for(char c: operations) {
+        if(c == '"') quoted= !quoted;
+        if(c == ';' && !quoted) {
+            ops.push_back(current);
+            current.clear();
+        } else {
+            current+= c;
+        }
+    }
+    ops.push_back(current);
+
+    for(const auto& op: ops) {
+        std::istringstream opStream(op);
+        std::string opcode;
+        if(!(opStream >> opcode)) continue;
+        std::string rest;
+        std::getline(opStream, rest);
+        size_t start= rest.find_first_not_of(' ');
+        rest= start == std::string::npos ? "" : rest.substr(start);
+
+        if(opcode == "bm" || opcode == "am") {
+            std::istringstream moves(rest);
+            std::string move;
+            while(moves >> move) (opcode == "bm" ? bm : am).push_back(move);
+        } else if(opcode == "id") {
+            if(rest.size() >= 2 && rest.front() == '"' && rest.back() == '"') rest= rest.substr(1, rest.size() - 2);
+            position.name= rest;
+        } else if(opcode == "hmvc") {
+            halfMoves= rest;
+        } else if(opcode == "fmvn") {
+            fullMoves= rest;
+        }
+    }
+    if(bm.empty() && am.empty()) {
+        error= "line " + std::to_string(lineNumber) + ": no bm or am operation";
+        return false;
+    }
+
+    position.fen= fields[0] + " " + fields[1] + " " + fields[2] + " " + fields[3] + " " + halfMoves + " " + fullMoves;
+    if(position.name.empty()) position.name= "Position_" + std::to_string(lineNumber);
+
+    // Resolve the SAN moves against the position
+    Board board;
+    board.setFen(position.fen);
+    for(const auto& text: bm) {
+        core::Move move;
+        if(!notation::parseMove(board, text, move)) {
+            error= "line " + std::to_string(lineNumber) + ": bm " + text + " is not a legal move";
+            return false;
+        }
+        position.bestMoves.push_back(move);
+        if(!position.expected.empty()) position.expected+= ' ';
+        position.expected+= move.ToString();
+    }
+    for(const auto& text: am) {
+        core::Move move;
+        if(!notation::parseMove(board, text, move)) {
+            error= "line " + std::to_string(lineNumber) + ": am " + text + " is not a legal move";
+            return false;
+        }
+        position.avoidMoves.push_back(move);
+        position.expected+= (position.expected.empty() ? "not " : " not ") + move.ToString();
+    }
+    return true;
+}
+
+bool EpdRunner::load(std::string& error) {
+    std::ifstream file(_options.path);
+    if(!file) {
+        error= "cannot open " + _options.path;
+        return false;
+    }
+    std::string line;
+    int lineNumber= 0;
+    while(std::getline(file, line)) {
+        lineNumber++;
+        if(!line.empty() && line.back() == '\r') line.pop_back();
+        if(line.find_first_not_of(" \t") == std::string::npos || line[0] == '#') continue;
+        Position position;
+        std::string lineError;
+        if(parseLine(line, lineNumber, position, lineError)) {
+            _positions.push_back(std::move(position));
+        } else {
+            std::cerr << "epd: skipping " << lineError << std::endl; // One bad record shouldn't sink the suite
+        }
+    }
+    if(_positions.empty()) {
+        error= "no usable positions in " + _options.path;
+        return false;
+    }
+    return true;
+}
+
+bool EpdRunner::isCorrect(const Position& position, const core::Move& move) const {
+    for(const auto& avoid: position.avoidMoves) {
+        if(sameMove(avoid, move)) return false;
+    }
+    if(position.bestMoves.empty()) return true;
+    for(const auto& best: position.bestMoves) {
+        if(sameMove(best, move)) return true;
+    }
+    return false;
+}
+
+EpdRunner::Result EpdRunner::solve(Bot& bot, const Position& position) {
+    Result result;
+    // Every position starts cold, so its result does not depend on what this worker solved before
+    bot.clearHash();
+    bot.resetHeuristics();
+    bot.setFen(position.fen);
+
+    // Track when the current best move first appeared; stop once it has held for stableMs
+    core::Move current;
+    int currentSince= 0;
+    int solvedAt= -1;
+    bot.setInfoCallback([&](const SearchInfo& info) {
+        if(info.multiPV != 1 || info.pv.empty()) return;
+        result.depth= info.depth;
+        result.nodes= info.nodes;
+        if(!sameMove(info.pv[0], current)) {
+            current= info.pv[0];
+            currentSince= info.timeMs;
+            solvedAt= isCorrect(position, current) ? info.timeMs : -1;
+        }
+        if(_options.stableMs > 0 && info.timeMs - currentSince >= _options.stableMs) bot.stopSearch();
+    });
+
+    SearchLimits limits;
+    limits.movetime= _options.movetimeMs;
+    auto start= std::chrono::steady_clock::now();
+    result.bestMove= bot.getBestMove(limits).first;
+    result.totalMs= std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    bot.setInfoCallback(nullptr);
+
+    result.solved= isCorrect(position, result.bestMove);
+    result.timeMs= (result.solved && solvedAt >= 0 && sameMove(result.bestMove, current)) ? solvedAt : result.totalMs;
+    return result;
+}
+
+int EpdRunner::run() {
+    std::string error;
+    if(!load(error)) {
+        std::cerr << "epd: " << error << std::endl;
+        return 1;
+    }
+
+    int workerCount= _options.workers > 0 ? _options.workers : std::max(1u, std::thread::hardware_concurrency());
+    workerCount= std::min<int>(workerCount, _positions.size());
+    std::cout << "epd: " << _positions.size() << " positions, " << workerCount << " workers, movetime "
+              << _options.movetimeMs << "ms, stable " << _options.stableMs << "ms" << std::endl;
+
+    std::vector<Result> results(_positions.size());
+    std::atomic<size_t> next= 0;
+    std::atomic<int> finished= 0;
+    std::mutex outputMutex;
+    auto worker= [&]() {
+        auto bot= std::make_unique<Bot>(std::make_shared<TranspositionTable>(_options.hashMB));
+        while(true) {
+            size_t index= next++;
+            if(index >= _positions.size()) return;
+            results[index]= solve(*bot, _positions[index]);
+
+            const Result& r= results[index];
+            std::lock_guard<std::mutex> lock(outputMutex);
+            std::cout << "[" << ++finished << "/" << _positions.size() << "] " << _positions[index].name << " "
+                      << (r.solved ? "PASS" : "FAIL") << " " << r.bestMove.ToString() << " (expected " << _positions[index].expected
+                      << ") depth " << r.depth << " time " << r.timeMs << "ms" << std::endl;
+        }
+    };
+    std::vector<std::thread> threads;
+    for(int i= 0; i < workerCount; ++i) threads.emplace_back(worker);
+    for(auto& thread: threads) thread.join();
+
+    // Same layout as benchmark.sh, so both can share one results file
+    std::ifstream existing(_options.csvPath);
+    bool needsHeader= !existing.good() || existing.peek() == std::ifstream::traits_type::eof();
+    existing.close();
+    std::ofstream csv(_options.csvPath, std::ios::app);
+    if(needsHeader) csv << "Timestamp,Label,Position_Name,Status,Depth,Nodes,Time_ms,NPS,BestMove,Expected\n";
+
+    std::time_t now= std::time(nullptr);
+    std::ostringstream timestamp;
+    timestamp << std::put_time(std::localtime(&now), "%Y-%m-%d %H:%M:%S");
+
+    int solved= 0;
+    uint64_t totalNodes= 0;
+    int64_t totalMs= 0, solvedMs= 0;
+    for(size_t i= 0; i < _positions.size(); ++i) {
+        const Result& r= results[i];
+        uint64_t nps= r.totalMs > 0 ? r.nodes * 1000ULL / r.totalMs : r.nodes;
+        csv << timestamp.str() << "," << csvField(_options.label) << "," << csvField(_positions[i].name) << "," << (r.solved ? "PASS" : "FAIL") << ","
+            << r.depth << "," << r.nodes << "," << r.timeMs << "," << nps << "," << r.bestMove.ToString() << "," << csvField(_positions[i].expected) << "\n";
+        solved+= r.solved;
+        totalNodes+= r.nodes;
+        totalMs+= r.totalMs;
+        if(r.solved) solvedMs+= r.timeMs;
+    }
+
+    std::cout << "epd: solved " << solved << "/" << _positions.size();
+    if(solved > 0) std::cout << ", average time to solution " << solvedMs / solved << "ms";
+    std::cout << ", " << totalNodes << " nodes, " << (totalMs > 0 ? totalNodes * 1000ULL / totalMs : totalNodes) << " nps per worker"
+              << ", results appended to " << _options.csvPath << std::endl;
+    return solved == static_cast<int>(_positions.size()) ? 0 : 1;
+}
+
+} // namespace talawachess
@@ -1,6 +1,7 @@
 #include "Evaluator.hpp"
 #include "Board.hpp"
 #include "Piece.hpp"
+#include "Profiler.hpp"
 namespace talawachess::bot::evaluator {
 int GetStaticPositionalPieceValue(core::Piece::Piece piece, int squareIndex) {
     if(piece == core::Piece::NONE) return 0;
@@ -12,6 +13,7 @@ int GetStaticPositionalPieceValue(core::Piece::Piece piece, int squareIndex) {
     return pstValue;
 }
 int evaluate(const talawachess::core::board::Board& _board) {
+    TALAWA_PROFILE_ZONE(EVALUATE);
     using namespace talawachess::core;
     int score= 0;
 
@@ -0,0 +1,180 @@
+#include "Json.hpp"
+#include <cctype>
+#include <cstdio>
+
+namespace talawachess::json {
+
+std::string Value::toJson() const {
+    return isString ? quote(text) : text;
+}
+
+std::string quote(const std::string& text) {
+    std::string out= "\"";
+    for(unsigned char c: text) {
+        switch(c) {
+        case '"': out+= "\\\""; break;
+        case '\\': out+= "\\\\"; break;
+        case '\n': out+= "\\n"; break;
+        case '\r': out+= "\\r"; break;
+        case '\t': out+= "\\t"; break;
+        default:
+            if(c < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                out+= escaped;
+            } else {
+                out+= static_cast<char>(c);
+            }
+        }
+    }
+    return out + "\"";
+}
+
+// Appends a BMP code point as UTF-8
+static void appendUtf8(std::string& out, unsigned codePoint) {
+    if(codePoint < 0x80) {
+        out+= static_cast<char>(codePoint);
+    } else if(codePoint < 0x800) {
+        out+= static_cast<char>(0xC0 | (codePoint >> 6));
+        out+= static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else {
+        out+= static_cast<char>(0xE0 | (codePoint >> 12));
+        out+= static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out+= static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+}
+
+static void skipSpace(const std::string& s, size_t& pos) {
+    while(pos < s.size() && std::isspace(static_cast<unsigned char>(s[pos]))) pos++;
+}
+
+// s[pos] is the opening quote; leaves pos after the closing quote
+static bool parseString(const std::string& s, size_t& pos, std::string& out, std::string& error) {
+    pos++;
+    while(pos < s.size()) {
+        char c= s[pos++];
+        if(c == '"') return true;
+        if(c != '\\') {
+            out+= c;
+            continue;
+        }
+        if(pos >= s.size()) break;
+        char e= s[pos++];
+        switch(e) {
+        case '"': out+= '"'; break;
+        case '\\': out+= '\\'; break;
+        case '/': out+= '/'; break;
+        case 'b': out+= '\b'; break;
+        case 'f': out+= '\f'; break;
+        case 'n': out+= '\n'; break;
+        case 'r': out+= '\r'; break;
+        case 't': out+= '\t'; break;
+        case 'u': {
+            if(pos + 4 > s.size() || !std::isxdigit(static_cast<unsigned char>(s[pos])) ||
+               !std::isxdigit(static_cast<unsigned char>(s[pos + 1])) || !std::isxdigit(static_cast<unsigned char>(s[pos + 2])) ||
+               !std::isxdigit(static_cast<unsigned char>(s[pos + 3]))) {
+                error= "invalid \\u escape";
+                return false;
+            }
+            appendUtf8(out, static_cast<unsigned>(std::stoul(s.substr(pos, 4), nullptr, 16)));
+            pos+= 4;
+            break;
+        }
+        default: error= std::string("invalid escape \\") + e; return false;
+        }
+    }
+    error= "unterminated string";
+    return false;
+}
+
+static bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// A bare value must be true, false, null or a number as JSON writes it:
+// -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+static bool isLiteral(const std::string& text) {
+    if(text == "true" || text == "false" || text == "null") return true;
+    size_t pos= 0;
+    if(pos < text.size() && text[pos] == '-') pos++;
+    if(pos >= text.size() || !isDigit(text[pos])) return false;
+    if(text[pos++] != '0') {
+        while(pos < text.size() && isDigit(text[pos])) pos++;
+    }
+    if(pos < text.size() && text[pos] == '.') {
+        if(++pos >= text.size() || !isDigit(text[pos])) return false;
+        while(pos < text.size() && isDigit(text[pos])) pos++;
+    }
+    if(pos < text.size() && (text[pos] == 'e' || text[pos] == 'E')) {
+        pos++;
+        if(pos < text.size() && (text[pos] == '+' || text[pos] == '-')) pos++;
+        if(pos >= text.size() || !isDigit(text[pos])) return false;
+        while(pos < text.size() && isDigit(text[pos])) pos++;
+    }
+    return pos == text.size();
+}
+
+bool parseObject(const std::string& line, Object& object, std::string& error) {
+    object.clear();
+    size_t pos= 0;
+    skipSpace(line, pos);
+    if(pos >= line.size() || line[pos] != '{') {
+        error= "expected '{'";
+        return false;
+    }
+    pos++;
+    skipSpace(line, pos);
+    if(pos < line.size() && line[pos] == '}') return true;
+
+    while(pos < line.size()) {
+        skipSpace(line, pos);
+        if(pos >= line.size() || line[pos] != '"') {
+            error= "expected a member name";
+            return false;
+        }
+        std::string key;
+        if(!parseString(line, pos, key, error)) return false;
+        skipSpace(line, pos);
+        if(pos >= line.size() || line[pos] != ':') {
+            error= "expected ':' after \"" + key + "\"";
+            return false;
+        }
+        pos++;
+        skipSpace(line, pos);
+
+        Value value;
+        if(pos < line.size() && line[pos] == '"') {
+            value.isString= true;
+            if(!parseString(line, pos, value.text, error)) return false;
+        } else if(pos < line.size() && (line[pos] == '{' || line[pos] == '[')) {
+            error= "nested values are not supported (\"" + key + "\")";
+            return false;
+        } else {
+            size_t start= pos;
+            while(pos < line.size() && line[pos] != ',' && line[pos] != '}' && !std::isspace(static_cast<unsigned char>(line[pos]))) pos++;
+            value.text= line.substr(start, pos - start);
+            if(value.text.empty()) {
+                error= "missing value for \"" + key + "\"";
+                return false;
+            }
+            if(!isLiteral(value.text)) { // Echoed back unquoted: must be valid JSON as it is
+                error= "invalid value for \"" + key + "\": " + value.text;
+                return false;
+            }
+        }
+        object[key]= value;
+
+        skipSpace(line, pos);
+        if(pos < line.size() && line[pos] == ',') {
+            pos++;
+            continue;
+        }
+        if(pos < line.size() && line[pos] == '}') return true;
+        error= "expected ',' or '}'";
+        return false;
+    }
+    error= "unterminated object";
+    return false;
+}
+
+} // namespace talawachess::json
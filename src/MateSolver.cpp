@@ -0,0 +1,228 @@
+#include "MateSolver.hpp"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+namespace talawachess {
+using namespace core::board;
+using namespace core;
+
+MateSolver::MateSolver(size_t hashSizeMB): _board(),
+                                           _moveGen(_board),
+                                           _tableSize((hashSizeMB * 1024 * 1024) / sizeof(Entry)) {}
+
+void MateSolver::checkStop() {
+    if(_stop) return;
+    if(_timeLimitMs > 0 && getElapsedTimeMs() >= _timeLimitMs) {
+        _stop= true;
+    }
+}
+
+int MateSolver::getElapsedTimeMs() const {
+    auto now= std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(now - _startTime).count();
+}
+
+// The remaining ply count is part of the key: a proof with n plies left says nothing about n - 2
+MateSolver::Entry& MateSolver::slot(uint64_t zobristHash, int remaining) {
+    uint64_t key= zobristHash ^ (static_cast<uint64_t>(remaining) * 0x9E3779B97F4A7C15ULL);
+    return _table[key % _table.size()];
+}
+
+void MateSolver::lookup(uint64_t zobristHash, int remaining, uint32_t& phi, uint32_t& delta) {
+    const Entry& entry= slot(zobristHash, remaining);
+    if(entry.zobristHash == zobristHash && entry.remaining == remaining && entry.generation == _generation) {
+        phi= entry.phi;
+        delta= entry.delta;
+    } else {
+        phi= 1; // Unexplored node
+        delta= 1;
+    }
+}
+
+void MateSolver::store(uint64_t zobristHash, int remaining, uint32_t phi, uint32_t delta) {
+    Entry& entry= slot(zobristHash, remaining);
+    entry.zobristHash= zobristHash;
+    entry.remaining= static_cast<int16_t>(remaining);
+    entry.phi= phi;
+    entry.delta= delta;
+    entry.generation= _generation;
+}
+
+bool MateSolver::inCheck() const {
+    Coordinate kingPos= (_board.activeColor == Piece::WHITE) ? _board.whiteKingPos : _board.blackKingPos;
+    Piece::Color oppColor= (_board.activeColor == Piece::WHITE) ? Piece::BLACK : Piece::WHITE;
+    return MoveGenerator::isSquareAttacked(_board, kingPos, oppColor);
+}
+
+// Legal moves of the side to move, with the hash of the resulting position.
+// Checking moves come first; in checks-only mode the attacker gets nothing else.
+void MateSolver::generateChildren(int remaining, std::vector<Child>& children) {
+    children.clear();
+    bool attacker= isAttacker(remaining);
+
+    MoveList moves;
+    _moveGen.generateMoves(moves);
+    size_t checks= 0;
+    for(const auto& move: moves) {
+        _board.makeMove(move);
+        if(!MoveGenerator::IsLegalPosition(_board)) {
+            _board.undoMove();
+            continue;
+        }
+        bool givesCheck= inCheck();
+        uint64_t childHash= _board.zobristHash;
+        _board.undoMove();
+
+        if(attacker && _checksOnly && !givesCheck) continue;
+        children.push_back({move, childHash});
+        if(givesCheck) std::swap(children[checks++], children.back());
+    }
+}
+
+void MateSolver::mid(int remaining, uint32_t thPhi, uint32_t thDelta) {
+    if((++_nodes & 1023) == 0) checkStop();
+    if(_stop) return;
+
+    uint64_t zobristHash= _board.zobristHash;
+    bool attacker= isAttacker(remaining);
+
+    std::vector<Child> children;
+    generateChildren(remaining, children);
+
+    // Terminal nodes
+    if(children.empty()) {
+        if(attacker || inCheck()) {
+            store(zobristHash, remaining, INF, 0); // Attacker has nothing left, or defender is mated
+        } else {
+            store(zobristHash, remaining, 0, INF); // Stalemate: the defender escapes
+        }
+        return;
+    }
+    if(!attacker && remaining == 0) {
+        store(zobristHash, remaining, 0, INF); // Defender has a legal move and the attacker ran out of plies
+        return;
+    }
+
+    while(true) {
+        // phi = min over children of their delta, delta = sum over children of their phi
+        uint32_t phi= INF;
+        uint32_t delta2= INF; // Second smallest child delta
+        uint64_t delta= 0;
+        uint32_t bestChildPhi= 0;
+        int best= -1;
+        for(int i= 0; i < static_cast<int>(children.size()); ++i) {
+            uint32_t childPhi, childDelta;
+            lookup(children[i].zobristHash, remaining - 1, childPhi, childDelta);
+            if(best < 0 || childDelta < phi) {
+                delta2= phi;
+                phi= childDelta;
+                bestChildPhi= childPhi;
+                best= i;
+            } else if(childDelta < delta2) {
+                delta2= childDelta;
+            }
+            delta= std::min<uint64_t>(INF, delta + childPhi);
+        }
+
+        if(phi >= thPhi || delta >= thDelta || _stop) {
+            store(zobristHash, remaining, phi, static_cast<uint32_t>(delta));
+            return;
+        }
+
+        // Thresholds for the most proving child, with the 1 + epsilon trick against thrashing
+        uint64_t childThPhi= std::min<uint64_t>(INF, uint64_t(thDelta) - delta + bestChildPhi);
+        uint64_t childThDelta= std::min<uint64_t>(thPhi, uint64_t(delta2) + delta2 / 4 + 1);
+
+        _board.makeMove(children[best].move);
+        mid(remaining - 1, static_cast<uint32_t>(childThPhi), static_cast<uint32_t>(childThDelta));
+        _board.undoMove();
+    }
+}
+
+std::vector<core::Move> MateSolver::extractPV(int remaining) {
+    std::vector<core::Move> pv;
+    std::vector<Child> children;
+
+    for(int r= remaining; r > 0; --r) {
+        generateChildren(r, children);
+        int chosen= -1;
+        if(isAttacker(r)) {
+            // Any move into a position that is lost for the defender
+            for(int i= 0; i < static_cast<int>(children.size()) && chosen < 0; ++i) {
+                uint32_t phi, delta;
+                lookup(children[i].zobristHash, r - 1, phi, delta);
+                if(delta == 0) chosen= i;
+            }
+        } else {
+            // Longest resistance: the reply whose shortest known proof needs the most plies
+            int longest= -1;
+            for(int i= 0; i < static_cast<int>(children.size()); ++i) {
+                for(int shorter= 1; shorter <= r - 1; shorter+= 2) {
+                    uint32_t phi, delta;
+                    lookup(children[i].zobristHash, shorter, phi, delta);
+                    if(phi != 0) continue;
+                    if(shorter > longest) {
+                        longest= shorter;
+                        chosen= i;
+                    }
+                    break;
+                }
+            }
+        }
+        if(chosen < 0) break;
+        pv.push_back(children[chosen].move);
+        _board.makeMove(children[chosen].move);
+    }
+
+    for(size_t i= 0; i < pv.size(); ++i) _board.undoMove();
+    return pv;
+}
+
+MateSolver::Result MateSolver::solve(const core::board::Board& board, int maxMoves, int timeLimitMs) {
+    _board= board;
+    _nodes= 0;
+    _startTime= std::chrono::steady_clock::now();
+    _timeLimitMs= timeLimitMs;
+    // Allocated by the first solve, so engine startup stays instant. Later solves start a new
+    // generation instead of zeroing the table; it is only wiped when the counter wraps around.
+    if(_table.empty()) _table.assign(_tableSize, Entry());
+    if(++_generation == 0) {
+        std::fill(_table.begin(), _table.end(), Entry());
+        _generation= 1;
+    }
+
+    Result result;
+    for(int moves= 1; moves <= maxMoves && !_stop; ++moves) {
+        _rootRemaining= 2 * moves - 1;
+        mid(_rootRemaining, INF, INF);
+        if(_stop) break;
+
+        uint32_t phi, delta;
+        lookup(_board.zobristHash, _rootRemaining, phi, delta);
+        int elapsedMs= getElapsedTimeMs();
+        uint64_t nps= elapsedMs > 0 ? (_nodes * 1000ULL / elapsedMs) : _nodes;
+
+        if(phi == 0) {
+            result.found= true;
+            result.mateIn= moves;
+            result.pv= extractPV(_rootRemaining);
+
+            std::ostringstream info;
+            info << "info depth " << _rootRemaining << " score mate " << moves << " time " << elapsedMs << " nodes " << _nodes << " nps " << nps << " pv";
+            for(const auto& move: result.pv) info << " " << move.ToString();
+            info << "\n";
+            std::cout << info.str() << std::flush;
+            break;
+        }
+        std::ostringstream info;
+        info << "info depth " << _rootRemaining << " time " << elapsedMs << " nodes " << _nodes << " nps " << nps << "\n";
+        std::cout << info.str() << std::flush;
+    }
+    result.nodes= _nodes;
+    result.stopped= !result.found && _stop;
+    _stop= false;
+    return result;
+}
+
+} // namespace talawachess
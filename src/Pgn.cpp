@@ -0,0 +1,192 @@
+#include "Pgn.hpp"
+#include "Notation.hpp"
+#include <cctype>
+#include <fstream>
+#include <sstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define TALAWA_HAS_MMAP 1
+#endif
+
+namespace talawachess::pgn {
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+void MappedFile::close() {
+#ifdef TALAWA_HAS_MMAP
+    if(_mapping != nullptr) munmap(_mapping, _mappingBytes);
+#endif
+    _mapping= nullptr;
+    _mappingBytes= 0;
+    _contents.clear();
+    _text= {};
+}
+
+bool MappedFile::open(const std::string& path, std::string& error) {
+    close();
+#ifdef TALAWA_HAS_MMAP
+    int fd= ::open(path.c_str(), O_RDONLY);
+    if(fd < 0) {
+        error= "cannot open " + path;
+        return false;
+    }
+    struct stat info;
+    if(fstat(fd, &info) != 0) {
+        ::close(fd);
+        error= "cannot stat " + path;
+        return false;
+    }
+    if(info.st_size > 0) {
+        void* mapping= mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(mapping == MAP_FAILED) {
+            ::close(fd);
+            error= "cannot map " + path;
+            return false;
+        }
+        madvise(mapping, info.st_size, MADV_SEQUENTIAL);
+        _mapping= mapping;
+        _mappingBytes= info.st_size;
+        _text= std::string_view(static_cast<const char*>(mapping), info.st_size);
+    }
+    ::close(fd); // The mapping stays valid
+    return true;
+#else
+    std::ifstream file(path, std::ios::binary);
+    if(!file) {
+        error= "cannot open " + path;
+        return false;
+    }
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    _contents= contents.str();
+    _text= _contents;
+    return true;
+#endif
+}
+
+std::string_view Game::tag(std::string_view name) const {
+    for(const auto& tag: tags) {
+        if(tag.name == name) return tag.value;
+    }
+    return {};
+}
+
+static bool isSpace(char c) {
+    return std::isspace(static_cast<unsigned char>(c));
+}
+
+// Rest of the line, without the newline
+static std::string_view takeLine(std::string_view& text) {
+    size_t end= text.find('\n');
+    std::string_view line= text.substr(0, end);
+    text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+    return line;
+}
+
+bool Reader::next(Game& game) {
+    game.tags.clear();
+    game.movetext= {};
+
+    // Tag pairs: [Name "Value"], one per line
+    while(!_rest.empty()) {
+        size_t start= 0;
+        while(start < _rest.size() && isSpace(_rest[start])) start++;
+        _rest.remove_prefix(start);
+        if(_rest.empty()) break;
+        if(_rest[0] == '%') { // Escaped line
+            takeLine(_rest);
+            continue;
+        }
+        if(_rest[0] != '[') break;
+        std::string_view line= takeLine(_rest);
+        size_t nameEnd= line.find_first_of(" \t\"", 1);
+        size_t open= line.find('"');
+        size_t close= line.rfind('"');
+        if(nameEnd == std::string_view::npos || open == std::string_view::npos || close <= open) continue;
+        game.tags.push_back({line.substr(1, nameEnd - 1), line.substr(open + 1, close - open - 1)});
+    }
+
+    // Movetext: up to the next tag section (a '[' starting a line outside a comment) or the end
+    const char* begin= _rest.data();
+    size_t length= 0;
+    int braceDepth= 0;
+    bool lineStart= true;
+    for(; length < _rest.size(); ++length) {
+        char c= _rest[length];
+        if(lineStart && braceDepth == 0 && c == '[') break;
+        if(c == '{') braceDepth++;
+        else if(c == '}' && braceDepth > 0) braceDepth--;
+        lineStart= c == '\n';
+    }
+    game.movetext= std::string_view(begin, length);
+    _rest.remove_prefix(length);
+    return !game.tags.empty() || game.movetext.find_first_not_of(" \t\r\n") != std::string_view::npos;
+}
+
+bool nextMoveToken(std::string_view& movetext, std::string_view& token) {
+    int parenDepth= 0;
+    while(!movetext.empty()) {
+        char c= movetext[0];
+        if(isSpace(c)) {
+            movetext.remove_prefix(1);
+        } else if(c == '{') {
+            size_t end= movetext.find('}');
+            movetext.remove_prefix(end == std::string_view::npos ? movetext.size() : end + 1);
+        } else if(c == ';') {
+            takeLine(movetext); // Comment to the end of the line
+        } else if(c == '(') {
+            parenDepth++;
+            movetext.remove_prefix(1);
+        } else if(c == ')') {
+            if(parenDepth > 0) parenDepth--;
+            movetext.remove_prefix(1);
+        } else {
+            size_t end= 0;
+            while(end < movetext.size() && !isSpace(movetext[end]) && movetext[end] != '{' && movetext[end] != '(' &&
+                  movetext[end] != ')' && movetext[end] != ';') {
+                end++;
+            }
+            std::string_view word= movetext.substr(0, end);
+            movetext.remove_prefix(end);
+            if(parenDepth > 0) continue; // Inside a variation
+
+            size_t dot= word.find_last_of('.');
+            if(dot != std::string_view::npos) word.remove_prefix(dot + 1); // "12." "12..." "12.e4"
+            if(word.empty() || word[0] == '$') continue;
+            if(word == "1-0" || word == "0-1" || word == "1/2-1/2" || word == "*") return false;
+            token= word;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string startFen(const Game& game) {
+    std::string_view fen= game.tag("FEN");
+    return fen.empty() ? std::string(core::board::Board::STARTING_POS) : std::string(fen);
+}
+
+bool replay(const Game& game, core::board::Board& board, std::vector<core::Move>& moves, std::string& error) {
+    board.setFen(startFen(game));
+    moves.clear();
+    std::string_view movetext= game.movetext;
+    std::string_view token;
+    while(nextMoveToken(movetext, token)) {
+        core::Move move;
+        if(!core::board::notation::parseSan(board, token, move)) {
+            error= "illegal move " + std::string(token) + " after " + std::to_string(moves.size()) + " plies";
+            return false;
+        }
+        board.makeMove(move);
+        moves.push_back(move);
+    }
+    return true;
+}
+
+} // namespace talawachess::pgn
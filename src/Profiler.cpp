@@ -0,0 +1,86 @@
+#include "Profiler.hpp"
+#include <iomanip>
+#include <sstream>
+
+#ifdef TALAWA_PROFILE
+#include <algorithm>
+#include <mutex>
+#include <vector>
+#endif
+
+namespace talawachess::profile {
+
+#ifdef TALAWA_PROFILE
+static const char* ZONE_NAMES[ZONE_COUNT]= {"search", "movegen", "makemove", "undomove", "attacks", "evaluate", "sortmoves"};
+
+// Threads alive now, and the sum of those that have exited
+static std::mutex registryMutex;
+static std::vector<Counters*> liveThreads;
+static Counters exitedThreads;
+
+// Tick rate calibration: ticks and wall time at the last reset
+static uint64_t startTicks= ticks();
+static auto startTime= std::chrono::steady_clock::now();
+
+ThreadCounters::ThreadCounters() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    liveThreads.push_back(&counters);
+}
+
+ThreadCounters::~ThreadCounters() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for(int zone= 0; zone < ZONE_COUNT; ++zone) {
+        exitedThreads.ticks[zone]+= counters.ticks[zone];
+        exitedThreads.calls[zone]+= counters.calls[zone];
+    }
+    liveThreads.erase(std::remove(liveThreads.begin(), liveThreads.end(), &counters), liveThreads.end());
+}
+
+std::string report() {
+    Counters total;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        total= exitedThreads;
+        for(const Counters* thread: liveThreads) {
+            for(int zone= 0; zone < ZONE_COUNT; ++zone) {
+                total.ticks[zone]+= thread->ticks[zone];
+                total.calls[zone]+= thread->calls[zone];
+            }
+        }
+    }
+    double elapsedNs= std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime).count();
+    uint64_t elapsedTicks= ticks() - startTicks;
+    double nsPerTick= elapsedTicks > 0 ? elapsedNs / elapsedTicks : 1.0;
+
+    std::ostringstream out;
+    out << std::fixed;
+    for(int zone= 0; zone < ZONE_COUNT; ++zone) {
+        double ms= total.ticks[zone] * nsPerTick / 1e6;
+        out << "info string profile " << std::left << std::setw(10) << ZONE_NAMES[zone] << std::right << " calls "
+            << std::setw(12) << total.calls[zone] << " ms " << std::setw(10) << std::setprecision(1) << ms << " ns/call "
+            << std::setw(7) << (total.calls[zone] > 0 ? total.ticks[zone] * nsPerTick / total.calls[zone] : 0.0);
+        if(zone != SEARCH) {
+            out << " search " << std::setw(5) << (total.ticks[SEARCH] > 0 ? 100.0 * total.ticks[zone] / total.ticks[SEARCH] : 0.0)
+                << "%";
+        }
+        out << "\n";
+    }
+    return out.str();
+}
+
+void reset() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    exitedThreads= Counters();
+    for(Counters* thread: liveThreads) *thread= Counters();
+    startTicks= ticks();
+    startTime= std::chrono::steady_clock::now();
+}
+#else
+std::string report() {
+    return "info string profile: not compiled in, configure with -DTALAWA_PROFILE=ON\n";
+}
+
+void reset() {}
+#endif
+
+} // namespace talawachess::profile
@@ -0,0 +1,74 @@
+#include "SearchStats.hpp"
+#include <iomanip>
+#include <sstream>
+
+namespace talawachess {
+
+SearchStats& SearchStats::operator+=(const SearchStats& other) {
+    nodes+= other.nodes;
+    qnodes+= other.qnodes;
+    ttProbes+= other.ttProbes;
+    ttHits+= other.ttHits;
+    ttCutoffs+= other.ttCutoffs;
+    failHighs+= other.failHighs;
+    failHighsFirst+= other.failHighsFirst;
+    nullMoveTries+= other.nullMoveTries;
+    nullMoveCutoffs+= other.nullMoveCutoffs;
+    lmrReductions+= other.lmrReductions;
+    lmrResearches+= other.lmrResearches;
+    mates+= other.mates;
+    return *this;
+}
+
+static double percent(uint64_t part, uint64_t whole) {
+    return whole > 0 ? 100.0 * part / whole : 0.0;
+}
+
+// Effective branching factor of each depth: its nodes over the previous depth's
+static std::vector<double> branchingFactors(const std::vector<uint64_t>& iterationNodes) {
+    std::vector<double> factors;
+    for(size_t i= 1; i < iterationNodes.size(); ++i) {
+        factors.push_back(iterationNodes[i - 1] > 0 ? static_cast<double>(iterationNodes[i]) / iterationNodes[i - 1] : 0.0);
+    }
+    return factors;
+}
+
+std::string SearchReport::toInfoString() const {
+    const SearchStats& s= totals;
+    uint64_t allNodes= s.nodes + s.qnodes;
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1);
+    out << "info string stats nodes " << allNodes << " main " << s.nodes << " qsearch " << s.qnodes << " ("
+        << percent(s.qnodes, allNodes) << "%) threads " << threads << " time " << timeMs << "ms\n";
+    out << "info string stats tt probes " << s.ttProbes << " hits " << s.ttHits << " (" << percent(s.ttHits, s.ttProbes)
+        << "%) cutoffs " << s.ttCutoffs << " (" << percent(s.ttCutoffs, s.ttProbes) << "%) hashfull " << hashfull << "\n";
+    out << "info string stats failhigh " << s.failHighs << " first " << s.failHighsFirst << " ("
+        << percent(s.failHighsFirst, s.failHighs) << "%) nullmove " << s.nullMoveTries << " cutoffs " << s.nullMoveCutoffs
+        << " (" << percent(s.nullMoveCutoffs, s.nullMoveTries) << "%) lmr " << s.lmrReductions << " researches "
+        << s.lmrResearches << " (" << percent(s.lmrResearches, s.lmrReductions) << "%) mates " << s.mates << "\n";
+    out << "info string stats ebf";
+    std::vector<double> factors= branchingFactors(iterationNodes);
+    out << std::setprecision(2);
+    for(size_t i= 0; i < factors.size(); ++i) out << " " << i + 2 << ":" << factors[i];
+    out << "\n";
+    return out.str();
+}
+
+std::string SearchReport::toJson() const {
+    const SearchStats& s= totals;
+    std::ostringstream out;
+    out << "{\"threads\":" << threads << ",\"timeMs\":" << timeMs << ",\"nodes\":" << s.nodes << ",\"qnodes\":" << s.qnodes
+        << ",\"ttProbes\":" << s.ttProbes << ",\"ttHits\":" << s.ttHits << ",\"ttCutoffs\":" << s.ttCutoffs
+        << ",\"hashfull\":" << hashfull << ",\"failHighs\":" << s.failHighs << ",\"failHighsFirst\":" << s.failHighsFirst
+        << ",\"nullMoveTries\":" << s.nullMoveTries << ",\"nullMoveCutoffs\":" << s.nullMoveCutoffs
+        << ",\"lmrReductions\":" << s.lmrReductions << ",\"lmrResearches\":" << s.lmrResearches << ",\"mates\":" << s.mates
+        << ",\"iterationNodes\":[";
+    for(size_t i= 0; i < iterationNodes.size(); ++i) out << (i ? "," : "") << iterationNodes[i];
+    out << "],\"ebf\":[" << std::fixed << std::setprecision(3);
+    std::vector<double> factors= branchingFactors(iterationNodes);
+    for(size_t i= 0; i < factors.size(); ++i) out << (i ? "," : "") << factors[i];
+    out << "]}";
+    return out.str();
+}
+
+} // namespace talawachess
@@ -0,0 +1,117 @@
+#include "SearchTelemetry.hpp"
+#include <algorithm>
+#include <sstream>
+
+namespace talawachess {
+
+static int64_t toUs(SearchTelemetry::Clock::duration d) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+}
+
+void SearchTelemetry::beginSearch(int hardLimitMs) {
+    _searchStart= Clock::now();
+    _clockStart= _searchStart;
+    _lastCheck= _searchStart;
+    _hardLimitMs= hardLimitMs;
+    _deadlineHit= false;
+    _maxCheckGapUs= 0;
+    _checks= 0;
+}
+
+void SearchTelemetry::timeChecked(Clock::time_point now) {
+    _maxCheckGapUs= std::max(_maxCheckGapUs, toUs(now - _lastCheck));
+    _lastCheck= now;
+    _checks++;
+}
+
+void SearchTelemetry::stopRequested() {
+    int64_t now= Clock::now().time_since_epoch().count();
+    int64_t none= 0;
+    _stopRequestNs.compare_exchange_strong(none, now);
+}
+
+int SearchTelemetry::overshootBucket(int64_t overshootUs) {
+    static const int64_t upperMs[OVERSHOOT_BUCKETS - 1]= {0, 5, 10, 25, 50, 100};
+    for(int i= 0; i < OVERSHOOT_BUCKETS - 1; ++i) {
+        if(overshootUs <= upperMs[i] * 1000) return i;
+    }
+    return OVERSHOOT_BUCKETS - 1;
+}
+
+std::string SearchTelemetry::endSearch() {
+    Clock::time_point bestmoveTime= Clock::now();
+    _searches++;
+    _gameMaxCheckGapUs= std::max(_gameMaxCheckGapUs, _maxCheckGapUs);
+
+    // What ended the search: the hard limit, a stop command, or the search itself (depth, soft limit)
+    int64_t stopRequestNs= _stopRequestNs;
+    const char* reason= "search";
+    bool hasEvent= false;
+    Clock::time_point event;
+    if(_deadlineHit) {
+        reason= "deadline";
+        event= _clockStart + std::chrono::milliseconds(_hardLimitMs);
+        hasEvent= true;
+        _deadlineHits++;
+    }
+    if(stopRequestNs != 0) {
+        Clock::time_point stopTime{Clock::duration(stopRequestNs)};
+        if(!hasEvent || stopTime < event) {
+            reason= "stop";
+            event= stopTime;
+        }
+        hasEvent= true;
+        _stopCommands++;
+    }
+
+    std::ostringstream info;
+    info << "info string telemetry end " << reason;
+    if(hasEvent) {
+        int64_t latencyUs= std::max<int64_t>(0, toUs(bestmoveTime - event));
+        _maxLatencyUs= std::max(_maxLatencyUs, latencyUs);
+        _totalLatencyUs+= latencyUs;
+        _latencySamples++;
+        info << " latency " << latencyUs / 1000.0 << "ms";
+    }
+    if(_hardLimitMs > 0) {
+        int64_t overshootUs= toUs(bestmoveTime - _clockStart) - int64_t(_hardLimitMs) * 1000;
+        _timedSearches++;
+        _maxOvershootUs= std::max(_maxOvershootUs, overshootUs);
+        _overshootHistogram[overshootBucket(overshootUs)]++;
+        info << " limit " << _hardLimitMs << "ms overshoot " << overshootUs / 1000.0 << "ms";
+    }
+    info << " maxcheckgap " << _maxCheckGapUs / 1000.0 << "ms checks " << _checks << "\n";
+    return info.str();
+}
+
+std::string SearchTelemetry::summary() const {
+    static const char* bucketNames[OVERSHOOT_BUCKETS]= {"<=0", "1-5", "6-10", "11-25", "26-50", "51-100", ">100"};
+
+    std::ostringstream out;
+    out << "info string telemetry searches " << _searches << " timed " << _timedSearches << " deadlines " << _deadlineHits
+        << " stops " << _stopCommands << "\n";
+    out << "info string telemetry latency max " << _maxLatencyUs / 1000.0 << "ms avg "
+        << (_latencySamples > 0 ? _totalLatencyUs / 1000.0 / _latencySamples : 0.0) << "ms maxcheckgap "
+        << _gameMaxCheckGapUs / 1000.0 << "ms";
+    if(_timedSearches > 0) out << " maxovershoot " << _maxOvershootUs / 1000.0 << "ms";
+    out << "\n";
+    out << "info string telemetry overshoot histogram";
+    for(int i= 0; i < OVERSHOOT_BUCKETS; ++i) out << " " << bucketNames[i] << ":" << _overshootHistogram[i];
+    out << "\n";
+    return out.str();
+}
+
+void SearchTelemetry::reset() {
+    _searches= 0;
+    _timedSearches= 0;
+    _deadlineHits= 0;
+    _stopCommands= 0;
+    _maxLatencyUs= 0;
+    _totalLatencyUs= 0;
+    _latencySamples= 0;
+    _maxOvershootUs= 0;
+    _gameMaxCheckGapUs= 0;
+    _overshootHistogram.fill(0);
+}
+
+} // namespace talawachess
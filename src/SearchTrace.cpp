@@ -0,0 +1,84 @@
+#include "SearchTrace.hpp"
+#include <cstring>
+
+namespace talawachess::trace {
+
+const char* reasonName(Reason reason) {
+    static const char* NAMES[REASON_COUNT]= {"searched", "beta",      "tt",   "rfp",     "nullmove",    "qsearch",
+                                             "draw",     "mate",      "stalemate", "maxdepth", "stopped", "start"};
+    return reason < REASON_COUNT ? NAMES[reason] : "?";
+}
+
+uint16_t encodeMove(const core::Move& move) {
+    if(move.from == move.to) return 0;
+    return static_cast<uint16_t>(move.from.ToIndex() | move.to.ToIndex() << 6 | core::Piece::GetPieceType(move.promotion) << 12);
+}
+
+std::string moveToString(uint16_t move) {
+    if(move == 0) return "null";
+    core::Move decoded;
+    decoded.from= core::board::Coordinate::FromIndex(move & 63);
+    decoded.to= core::board::Coordinate::FromIndex((move >> 6) & 63);
+    int promotion= (move >> 12) & 7;
+    if(promotion != 0) decoded.promotion= static_cast<core::Piece::Piece>(promotion);
+    return decoded.ToString();
+}
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+};
+
+Recorder::Recorder(size_t bufferRecords): _buffer(bufferRecords) {}
+
+Recorder::~Recorder() {
+    flush();
+    if(_file != nullptr) std::fclose(_file);
+}
+
+bool Recorder::open(const std::string& path, std::string& error) {
+    flush();
+    if(_file != nullptr) std::fclose(_file);
+    _file= std::fopen(path.c_str(), "wb");
+    if(_file == nullptr) {
+        error= "cannot write " + path;
+        return false;
+    }
+    FileHeader header;
+    std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+    header.version= FILE_VERSION;
+    header.recordSize= sizeof(Record);
+    std::fwrite(&header, sizeof(header), 1, _file);
+    return true;
+}
+
+void Recorder::flush() {
+    if(_file != nullptr && _count > 0) {
+        std::fwrite(_buffer.data(), sizeof(Record), _count, _file);
+        std::fflush(_file);
+    }
+    _count= 0;
+}
+
+bool readFile(const std::string& path, std::vector<Record>& records, std::string& error) {
+    std::FILE* file= std::fopen(path.c_str(), "rb");
+    if(file == nullptr) {
+        error= "cannot open " + path;
+        return false;
+    }
+    FileHeader header;
+    if(std::fread(&header, sizeof(header), 1, file) != 1 || std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+        error= path + " is not a search trace";
+    } else if(header.version != FILE_VERSION || header.recordSize != sizeof(Record)) {
+        error= "trace version " + std::to_string(header.version) + " is not supported";
+    } else {
+        Record record;
+        records.clear();
+        while(std::fread(&record, sizeof(record), 1, file) == 1) records.push_back(record);
+    }
+    std::fclose(file);
+    return error.empty();
+}
+
+} // namespace talawachess::trace
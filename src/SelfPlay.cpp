@@ -0,0 +1,307 @@
+#include "SelfPlay.hpp"
+#include "Notation.hpp"
+#include "Pgn.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace talawachess {
+using namespace core::board;
+using namespace core::Piece;
+
+bool isDrawByRule(const Board& board) {
+    if(board.halfMoveClock >= 100) return true;
+
+    // Threefold repetition: the current position seen twice before since the last irreversible move
+    int repetitions= 0;
+    int limit= std::max(0, static_cast<int>(board.game_history.size()) - board.halfMoveClock);
+    for(int i= board.game_history.size() - 2; i >= limit; i-= 2) {
+        if(board.game_history[i].zobristHash == board.zobristHash && ++repetitions >= 2) return true;
+    }
+
+    // Insufficient material: bare kings, or a single minor piece left
+    int minors= 0;
+    for(Piece piece: board.squares) {
+        PieceType type= GetPieceType(piece);
+        if(type == NONE || type == KING) continue;
+        if(type != KNIGHT && type != BISHOP) return false;
+        minors++;
+    }
+    return minors <= 1;
+}
+
+SelfPlay::SelfPlay(const SelfPlayOptions& options): _options(options) {}
+
+// Openings are kept as a start FEN plus UCI moves, so repetitions through the opening count
+struct Opening {
+    std::string fen= Board::STARTING_POS;
+    std::vector<std::string> moves;
+};
+
+static std::string openingToText(const Opening& opening) {
+    std::string text= opening.fen;
+    for(const auto& move: opening.moves) text+= " " + move;
+    return text;
+}
+
+static Opening openingFromText(const std::string& text) {
+    // Six FEN fields, then the moves
+    Opening opening;
+    std::istringstream ss(text);
+    std::string field;
+    opening.fen.clear();
+    for(int i= 0; i < 6 && ss >> field; ++i) opening.fen+= (i ? " " : "") + field;
+    while(ss >> field) opening.moves.push_back(field);
+    return opening;
+}
+
+bool SelfPlay::loadOpenings(std::string& error) {
+    _openings.clear();
+    if(_options.openingsPath.empty()) {
+        _openings.push_back(openingToText(Opening()));
+        return true;
+    }
+    std::ifstream file(_options.openingsPath);
+    if(!file) {
+        error= "cannot open " + _options.openingsPath;
+        return false;
+    }
+    const std::string& path= _options.openingsPath;
+    bool isPgn= path.size() >= 4 && path.compare(path.size() - 4, 4, ".pgn") == 0;
+    std::string line;
+
+    if(!isPgn) {
+        while(std::getline(file, line)) {
+            std::istringstream ss(line);
+            std::string fields[4];
+            if(line.empty() || line[0] == '#' || !(ss >> fields[0] >> fields[1] >> fields[2] >> fields[3])) continue;
+            Opening opening;
+            opening.fen= fields[0] + " " + fields[1] + " " + fields[2] + " " + fields[3] + " 0 1";
+            _openings.push_back(openingToText(opening));
+        }
+    } else {
+        pgn::MappedFile pgnFile;
+        if(!pgnFile.open(path, error)) return false;
+        pgn::Reader reader(pgnFile.text());
+        pgn::Game game;
+        Board board;
+        while(reader.next(game)) {
+            Opening opening;
+            opening.fen= pgn::startFen(game);
+            board.setFen(opening.fen);
+            std::string_view movetext= game.movetext;
+            std::string_view token;
+            core::Move move;
+            while(static_cast<int>(opening.moves.size()) < _options.openingPlies && pgn::nextMoveToken(movetext, token) &&
+                  notation::parseSan(board, token, move)) { // Keeps the legal prefix
+                board.makeMove(move);
+                opening.moves.push_back(move.ToString());
+            }
+            _openings.push_back(openingToText(opening));
+        }
+    }
+    if(_openings.empty()) {
+        error= "no openings in " + path;
+        return false;
+    }
+    return true;
+}
+
+GameResult SelfPlay::playGame(Bot& white, Bot& black, const std::string& openingText, std::string& reason) const {
+    Opening opening= openingFromText(openingText);
+    Board board;
+    board.setFen(opening.fen);
+    for(Bot* bot: {&white, &black}) {
+        bot->resetHeuristics();
+        bot->setFen(opening.fen);
+    }
+    auto play= [&](const std::string& move) {
+        core::Move parsed;
+        notation::parseMove(board, move, parsed);
+        board.makeMove(parsed);
+        white.performMove(move);
+        black.performMove(move);
+    };
+    for(const auto& move: opening.moves) play(move);
+
+    int clock[2]= {_options.baseTimeMs, _options.baseTimeMs}; // [white, black]
+    int resignCount= 0, drawCount= 0;
+    int lastWinner= 0; // +1 white, -1 black: side the resign counter is running for
+    for(int ply= 0;; ++ply) {
+        MoveList legalMoves;
+        notation::generateLegalMoves(board, legalMoves);
+        bool whiteToMove= board.activeColor == WHITE;
+        if(legalMoves.empty()) {
+            Coordinate king= whiteToMove ? board.whiteKingPos : board.blackKingPos;
+            if(!MoveGenerator::isSquareAttacked(board, king, whiteToMove ? BLACK : WHITE)) {
+                reason= "stalemate";
+                return GameResult::DRAW;
+            }
+            reason= "checkmate";
+            return whiteToMove ? GameResult::BLACK_WIN : GameResult::WHITE_WIN;
+        }
+        if(isDrawByRule(board)) {
+            reason= "draw by rule";
+            return GameResult::DRAW;
+        }
+        if(ply >= _options.maxPlies) {
+            reason= "move limit";
+            return GameResult::DRAW;
+        }
+
+        SearchLimits limits;
+        limits.wtime= clock[0];
+        limits.btime= clock[1];
+        limits.winc= _options.incrementMs;
+        limits.binc= _options.incrementMs;
+        Bot& engine= whiteToMove ? white : black;
+        auto start= std::chrono::steady_clock::now();
+        auto [move, score]= engine.getBestMove(limits);
+        int elapsedMs= std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+        int& remaining= clock[whiteToMove ? 0 : 1];
+        remaining-= elapsedMs;
+        if(remaining < 0) {
+            reason= "time forfeit";
+            return whiteToMove ? GameResult::BLACK_WIN : GameResult::WHITE_WIN;
+        }
+        remaining+= _options.incrementMs;
+
+        // Adjudication, on scores from white's point of view
+        int whiteScore= whiteToMove ? score : -score;
+        int winner= whiteScore >= _options.resignScore ? 1 : (whiteScore <= -_options.resignScore ? -1 : 0);
+        resignCount= (winner != 0 && winner == lastWinner) ? resignCount + 1 : (winner != 0 ? 1 : 0);
+        lastWinner= winner;
+        if(_options.resignMoves > 0 && resignCount >= 2 * _options.resignMoves) {
+            reason= "adjudicated win";
+            return winner > 0 ? GameResult::WHITE_WIN : GameResult::BLACK_WIN;
+        }
+        drawCount= std::abs(whiteScore) <= _options.drawScore ? drawCount + 1 : 0;
+        if(_options.drawMoves > 0 && board.fullMoveNumber >= _options.drawMoveNumber && drawCount >= 2 * _options.drawMoves) {
+            reason= "adjudicated draw";
+            return GameResult::DRAW;
+        }
+
+        play(move.ToString());
+    }
+}
+
+// Expected score for an Elo difference, and back
+static double expectedScore(double elo) {
+    return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+}
+
+double SelfPlay::elo(double score) {
+    score= std::clamp(score, 1e-6, 1.0 - 1e-6);
+    return 400.0 * std::log10(score / (1.0 - score));
+}
+
+// Generalized SPRT log-likelihood ratio on the trinomial (W/D/L) results, using the normal
+// approximation with the measured variance
+double SelfPlay::llr(const Score& score) const {
+    int n= score.games();
+    if(n == 0 || score.wins + score.losses == 0) return 0.0; // No variance information yet
+    double w= static_cast<double>(score.wins) / n;
+    double d= static_cast<double>(score.draws) / n;
+    double l= static_cast<double>(score.losses) / n;
+    double mean= w + d / 2.0;
+    double variance= w * (1.0 - mean) * (1.0 - mean) + d * (0.5 - mean) * (0.5 - mean) + l * mean * mean;
+    if(variance <= 0.0) return 0.0;
+    double s0= expectedScore(_options.elo0);
+    double s1= expectedScore(_options.elo1);
+    return (s1 - s0) * (2.0 * mean - s0 - s1) / (2.0 * variance / n);
+}
+
+int SelfPlay::run() {
+    std::string error;
+    if(!_devParams.parse(_options.devParams, error) || !_baseParams.parse(_options.baseParams, error) || !loadOpenings(error)) {
+        std::cerr << "selfplay: " << error << std::endl;
+        return 1;
+    }
+    int slots= _options.concurrency > 0 ? _options.concurrency : std::max(1u, std::thread::hardware_concurrency());
+    slots= std::min(slots, _options.games);
+    double lowerBound= std::log(_options.beta / (1.0 - _options.alpha));
+    double upperBound= std::log((1.0 - _options.beta) / _options.alpha);
+
+    std::cout << "selfplay: dev  " << _devParams.toString() << "\n"
+              << "selfplay: base " << _baseParams.toString() << "\n"
+              << "selfplay: " << _openings.size() << " openings, " << slots << " concurrent games, tc "
+              << _options.baseTimeMs / 1000.0 << "+" << _options.incrementMs / 1000.0 << "s, SPRT elo0 " << _options.elo0
+              << " elo1 " << _options.elo1 << " alpha " << _options.alpha << " beta " << _options.beta << std::endl;
+
+    Score score;
+    std::atomic<int> nextGame= 0;
+    std::atomic<bool> finished= false;
+    double finalLlr= 0.0;
+    std::mutex scoreMutex;
+
+    auto worker= [&]() {
+        // Each game slot owns one engine per side of the match, reused game after game
+        auto dev= std::make_unique<Bot>(std::make_shared<TranspositionTable>(_options.hashMB));
+        auto base= std::make_unique<Bot>(std::make_shared<TranspositionTable>(_options.hashMB));
+        dev->setSearchParams(_devParams);
+        base->setSearchParams(_baseParams);
+        for(Bot* bot: {dev.get(), base.get()}) {
+            bot->setInfoCallback([](const SearchInfo&) {});
+        }
+
+        while(!finished) {
+            int game= nextGame++;
+            if(game >= _options.games) return;
+            const std::string& opening= _openings[(game / 2) % _openings.size()];
+            bool devIsWhite= game % 2 == 0;
+            std::string reason;
+            GameResult result= devIsWhite ? playGame(*dev, *base, opening, reason) : playGame(*base, *dev, opening, reason);
+
+            std::lock_guard<std::mutex> lock(scoreMutex);
+            if(finished) return; // The SPRT already ended while this game was running
+            const char* text= "1/2-1/2";
+            if(result == GameResult::WHITE_WIN) text= "1-0";
+            if(result == GameResult::BLACK_WIN) text= "0-1";
+            if(result == GameResult::DRAW) {
+                score.draws++;
+            } else if((result == GameResult::WHITE_WIN) == devIsWhite) {
+                score.wins++;
+            } else {
+                score.losses++;
+            }
+
+            int n= score.games();
+            double mean= (score.wins + score.draws / 2.0) / n;
+            double variance= (score.wins * (1.0 - mean) * (1.0 - mean) + score.draws * (0.5 - mean) * (0.5 - mean) +
+                              score.losses * mean * mean) /
+                             n;
+            double margin= 1.96 * std::sqrt(variance / n);
+            finalLlr= llr(score);
+            std::cout << "Game " << n << " (" << (devIsWhite ? "dev-base" : "base-dev") << ") " << text << " " << reason
+                      << " | W " << score.wins << " D " << score.draws << " L " << score.losses << std::fixed << std::setprecision(1)
+                      << " | Elo " << elo(mean) << " +/- " << (elo(mean + margin) - elo(mean - margin)) / 2.0 << std::setprecision(2)
+                      << " | LLR " << finalLlr << " [" << lowerBound << ", " << upperBound << "]" << std::defaultfloat << std::endl;
+            if(finalLlr >= upperBound || finalLlr <= lowerBound) finished= true;
+        }
+    };
+    std::vector<std::thread> threads;
+    for(int i= 0; i < slots; ++i) threads.emplace_back(worker);
+    for(auto& thread: threads) thread.join();
+
+    std::cout << "selfplay: " << score.games() << " games, W " << score.wins << " D " << score.draws << " L " << score.losses << ", ";
+    if(finalLlr >= upperBound) {
+        std::cout << "H1 accepted (elo >= " << _options.elo1 << ")" << std::endl;
+    } else if(finalLlr <= lowerBound) {
+        std::cout << "H0 accepted (elo <= " << _options.elo0 << ")" << std::endl;
+        return 1;
+    } else {
+        std::cout << "SPRT inconclusive" << std::endl;
+    }
+    return 0;
+}
+
+} // namespace talawachess
@@ -0,0 +1,68 @@
+#include "TimeManager.hpp"
+#include <algorithm>
+
+namespace talawachess {
+
+void TimeManager::init(const SearchLimits& limits, core::Piece::Color us, int moveOverheadMs) {
+    _softLimitMs= 0;
+    _hardLimitMs= 0;
+    _stableIterations= 0;
+    _hasPreviousScore= false;
+    _fixedTime= false;
+
+    if(limits.movetime > 0) {
+        // Fixed time per move: nothing to adapt, just keep the overhead off the clock
+        _hardLimitMs= std::max(1, limits.movetime - moveOverheadMs);
+        _softLimitMs= _hardLimitMs;
+        _fixedTime= true;
+    } else if(!limits.infinite && limits.depth == 0 && limits.mate == 0 && limits.hasClock()) {
+        int myTime= (us == core::Piece::WHITE) ? limits.wtime : limits.btime;
+        int myInc= (us == core::Piece::WHITE) ? limits.winc : limits.binc;
+
+        // Time we can actually spend, keeping the GUI/network overhead in reserve
+        int available= std::max(1, myTime - moveOverheadMs);
+        int movesToGo= limits.movestogo > 0 ? std::min(limits.movestogo, 50) : 35;
+
+        int optimum= available / movesToGo + myInc * 3 / 4;
+        _softLimitMs= std::min(optimum, available * 6 / 10);
+        _hardLimitMs= std::min(optimum * 4, available * 3 / 4);
+        _softLimitMs= std::max(1, _softLimitMs);
+        _hardLimitMs= std::max(_softLimitMs, _hardLimitMs);
+    } else if(!limits.infinite && limits.depth == 0 && limits.nodes == 0 && limits.mate == 0) {
+        // No time info and not infinite/depth/mate - default to 5 seconds
+        _hardLimitMs= 5000;
+        _softLimitMs= _hardLimitMs;
+        _fixedTime= true;
+    }
+    _adjustedSoftLimitMs= _softLimitMs;
+}
+
+bool TimeManager::shouldStop(int elapsedMs, bool bestMoveChanged, int score, double bestMoveNodeFraction) {
+    if(!isTimed() || _fixedTime) return false;
+
+    _stableIterations= bestMoveChanged ? 0 : _stableIterations + 1;
+
+    // 1. Best move stability: a move that survived several iterations needs less confirmation
+    double stabilityFactor= 1.3 - 0.1 * std::min(_stableIterations, 6);
+
+    // 2. Score drop: spend more when the last iteration got worse news
+    double scoreFactor= 1.0;
+    if(_hasPreviousScore) {
+        int drop= _previousScore - score;
+        scoreFactor= std::clamp(1.0 + drop / 200.0, 0.8, 1.6);
+    }
+    _previousScore= score;
+    _hasPreviousScore= true;
+
+    // 3. Node distribution: if nearly all effort went into the best move, the alternatives are clearly worse
+    double nodeFactor= std::clamp(0.4 + 1.2 * (1.0 - bestMoveNodeFraction), 0.5, 1.5);
+
+    double adjusted= _softLimitMs * stabilityFactor * scoreFactor * nodeFactor;
+    _adjustedSoftLimitMs= std::min(_hardLimitMs, static_cast<int>(adjusted));
+
+    // The next iteration typically takes longer than everything so far; don't start
+    // one that would most likely be cut off by the hard limit.
+    return elapsedMs >= _adjustedSoftLimitMs / 2;
+}
+
+} // namespace talawachess
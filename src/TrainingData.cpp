@@ -0,0 +1,177 @@
+#include "TrainingData.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+
+namespace talawachess::data {
+using namespace core::board;
+using namespace core::Piece;
+
+PackedPosition pack(const Board& board, int whiteScore, int result) {
+    PackedPosition packed{};
+    int count= 0;
+    for(int square= 0; square < 64; ++square) {
+        Piece piece= board.squares[square];
+        if(piece == NONE) continue;
+        packed.occupancy|= 1ULL << square;
+        uint8_t code= GetPieceType(piece) | (IsColor(piece, BLACK) ? 8 : 0);
+        packed.pieces[count / 2]|= (count % 2 == 0) ? code : code << 4;
+        count++;
+    }
+    packed.flags= (board.activeColor == BLACK ? 1 : 0) | (board.castlingRights << 1);
+    packed.enPassant= board.enPassantIndex < 0 ? 64 : board.enPassantIndex;
+    packed.halfMoveClock= std::min(board.halfMoveClock, 255);
+    packed.result= result;
+    packed.score= std::clamp(whiteScore, -32000, 32000);
+    packed.fullMoveNumber= std::min(board.fullMoveNumber, 65535);
+    return packed;
+}
+
+void unpack(const PackedPosition& packed, Board& board) {
+    std::fill(std::begin(board.squares), std::end(board.squares), NONE);
+    board.game_history.clear();
+    int count= 0;
+    for(uint64_t bits= packed.occupancy; bits; bits&= bits - 1) {
+        int square= std::countr_zero(bits);
+        uint8_t code= (packed.pieces[count / 2] >> (count % 2 == 0 ? 0 : 4)) & 0xF;
+        count++;
+        Piece piece= (code & 7) | ((code & 8) ? BLACK : WHITE);
+        board.squares[square]= piece;
+        if(IsType(piece, KING)) (IsColor(piece, WHITE) ? board.whiteKingPos : board.blackKingPos)= Coordinate(square);
+    }
+    board.activeColor= (packed.flags & 1) ? BLACK : WHITE;
+    board.castlingRights= (packed.flags >> 1) & 0xF;
+    board.enPassantIndex= packed.enPassant >= 64 ? -1 : packed.enPassant;
+    board.halfMoveClock= packed.halfMoveClock;
+    board.fullMoveNumber= packed.fullMoveNumber;
+    board.zobristHash= board.calculateHash();
+}
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+};
+static_assert(sizeof(FileHeader) == 16, "FileHeader is a fixed on-disk layout");
+
+static bool headerMatches(const FileHeader& header, std::string& error) {
+    if(std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+        error= "not a talawachess data file";
+        return false;
+    }
+    if(header.version != FILE_VERSION || header.recordSize != sizeof(PackedPosition)) {
+        error= "data file version " + std::to_string(header.version) + " is not supported";
+        return false;
+    }
+    return true;
+}
+
+DataWriter::~DataWriter() {
+    close();
+}
+
+bool DataWriter::open(const std::string& path, std::string& error) {
+    close();
+    // Drop a record torn by an interrupted run, so new records stay aligned
+    std::error_code ec;
+    uintmax_t bytes= std::filesystem::file_size(path, ec);
+    if(!ec && bytes > sizeof(FileHeader) && (bytes - sizeof(FileHeader)) % sizeof(PackedPosition) != 0) {
+        std::filesystem::resize_file(path, bytes - (bytes - sizeof(FileHeader)) % sizeof(PackedPosition), ec);
+    }
+    _file= std::fopen(path.c_str(), "a+b");
+    if(!_file) {
+        error= "cannot open " + path + " for writing";
+        return false;
+    }
+    std::fseek(_file, 0, SEEK_END);
+    if(std::ftell(_file) == 0) {
+        FileHeader header;
+        std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+        header.version= FILE_VERSION;
+        header.recordSize= sizeof(PackedPosition);
+        std::fwrite(&header, sizeof(header), 1, _file);
+    } else {
+        FileHeader header;
+        std::fseek(_file, 0, SEEK_SET);
+        if(std::fread(&header, sizeof(header), 1, _file) != 1 || !headerMatches(header, error)) {
+            if(error.empty()) error= "truncated header";
+            error= path + ": " + error;
+            close();
+            return false;
+        }
+        std::fseek(_file, 0, SEEK_END); // "a" mode appends anyway; this just keeps ftell meaningful
+    }
+    return true;
+}
+
+void DataWriter::write(const PackedPosition* records, size_t count) {
+    static const size_t BUFFER_RECORDS= 1 << 15; // 1 MB
+    _buffer.insert(_buffer.end(), records, records + count);
+    if(_buffer.size() >= BUFFER_RECORDS) flush();
+}
+
+void DataWriter::flush() {
+    if(!_file) return;
+    if(!_buffer.empty()) std::fwrite(_buffer.data(), sizeof(PackedPosition), _buffer.size(), _file);
+    _buffer.clear();
+    std::fflush(_file);
+}
+
+void DataWriter::close() {
+    if(!_file) return;
+    flush();
+    std::fclose(_file);
+    _file= nullptr;
+}
+
+DataReader::~DataReader() {
+    close();
+}
+
+bool DataReader::open(const std::string& path, std::string& error) {
+    close();
+    _file= std::fopen(path.c_str(), "rb");
+    if(!_file) {
+        error= "cannot open " + path;
+        return false;
+    }
+    FileHeader header;
+    if(std::fread(&header, sizeof(header), 1, _file) != 1 || !headerMatches(header, error)) {
+        if(error.empty()) error= "truncated header";
+        error= path + ": " + error;
+        close();
+        return false;
+    }
+    std::fseek(_file, 0, SEEK_END);
+    long bytes= std::ftell(_file);
+    _recordCount= (bytes - sizeof(FileHeader)) / sizeof(PackedPosition); // A torn last record is ignored
+    std::fseek(_file, sizeof(FileHeader), SEEK_SET);
+    _buffer.clear();
+    _bufferPos= 0;
+    return true;
+}
+
+bool DataReader::next(PackedPosition& record) {
+    static const size_t BUFFER_RECORDS= 1 << 15;
+    if(_bufferPos == _buffer.size()) {
+        if(!_file) return false;
+        _buffer.resize(BUFFER_RECORDS);
+        size_t read= std::fread(_buffer.data(), sizeof(PackedPosition), BUFFER_RECORDS, _file);
+        _buffer.resize(read);
+        _bufferPos= 0;
+        if(read == 0) return false;
+    }
+    record= _buffer[_bufferPos++];
+    return true;
+}
+
+void DataReader::close() {
+    if(_file) std::fclose(_file);
+    _file= nullptr;
+    _buffer.clear();
+    _bufferPos= 0;
+    _recordCount= 0;
+}
+
+} // namespace talawachess::data
@@ -0,0 +1,405 @@
+#include "TranspositionTable.hpp"
+#include "Board.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define TALAWA_HAS_SHM 1
+#endif
+
+namespace talawachess {
+
+// Shared entries are plain atomics living in memory mapped by several processes
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared TT entries need lock-free 64-bit atomics");
+
+TranspositionTable::TranspositionTable(size_t sizeInMB) {
+    resize(sizeInMB);
+}
+
+TranspositionTable::~TranspositionTable() {
+    releaseOwned();
+    releaseShared();
+}
+
+// Tables of a few MB or more start on a 2 MB boundary, so the kernel can back them with
+// transparent huge pages: one TLB entry then covers 512 times as many buckets
+static constexpr size_t HUGE_PAGE_BYTES= 2 * 1024 * 1024;
+
+void TranspositionTable::resize(size_t sizeInMB) {
+    allocate(std::max<size_t>(1, (sizeInMB * 1024 * 1024) / sizeof(Bucket)));
+}
+
+void TranspositionTable::allocate(size_t bucketCount) {
+    releaseShared();
+    releaseOwned(); // Free the old table before allocating the new one
+    _bucketCount= bucketCount;
+    size_t bytes= _bucketCount * sizeof(Bucket);
+#ifdef TALAWA_HAS_SHM
+    // An anonymous mapping is zero-filled and only backed by memory once touched: allocating
+    // even a large table is instant, and all-zero words are empty entries
+    size_t alignment= bytes >= HUGE_PAGE_BYTES ? HUGE_PAGE_BYTES : 0;
+    void* mapping= mmap(nullptr, bytes + alignment, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(mapping == MAP_FAILED) throw std::bad_alloc();
+    char* start= static_cast<char*>(mapping);
+    if(alignment > 0) {
+        // Trim the slack on both sides down to the aligned range
+        char* aligned= reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(start) + alignment - 1) & ~(alignment - 1));
+        size_t head= aligned - start;
+        if(head > 0) munmap(start, head);
+        if(alignment - head > 0) munmap(aligned + bytes, alignment - head);
+        start= aligned;
+#ifdef MADV_HUGEPAGE
+        madvise(start, bytes, MADV_HUGEPAGE); // Only a hint: fine if THP is disabled
+#endif
+    }
+    _memory= start;
+    _memoryBytes= bytes;
+    _untouched= true;
+#else
+    _memory= ::operator new(bytes, std::align_val_t(alignof(Bucket)));
+    _memoryBytes= bytes;
+#endif
+    _buckets= static_cast<Bucket*>(_memory);
+#ifndef TALAWA_HAS_SHM
+    clear(std::max(1u, std::thread::hardware_concurrency())); // Heap memory is not zeroed
+#endif
+}
+
+void TranspositionTable::releaseOwned() {
+    if(_memory != nullptr) {
+#ifdef TALAWA_HAS_SHM
+        munmap(_memory, _memoryBytes);
+#else
+        ::operator delete(_memory, std::align_val_t(alignof(Bucket)));
+#endif
+    }
+    _memory= nullptr;
+    _memoryBytes= 0;
+}
+
+void TranspositionTable::releaseShared() {
+#ifdef TALAWA_HAS_SHM
+    if(_mapping != nullptr) munmap(_mapping, _mappingBytes);
+#endif
+    _mapping= nullptr;
+    _mappingBytes= 0;
+    _mayClearMapping= false;
+}
+
+bool TranspositionTable::attachShared(const std::string& name, size_t sizeInMB, std::string& error) {
+#ifdef TALAWA_HAS_SHM
+    std::string shmName= (!name.empty() && name[0] == '/') ? name : "/" + name;
+
+    // Whoever creates the segment sizes it and publishes the header; everybody else waits for the magic
+    bool creator= true;
+    int fd= shm_open(shmName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if(fd < 0 && errno == EEXIST) {
+        creator= false;
+        fd= shm_open(shmName.c_str(), O_RDWR, 0600);
+    }
+    if(fd < 0) {
+        error= "shm_open " + shmName + ": " + std::strerror(errno);
+        return false;
+    }
+    if(!attachMapping(fd, creator, sizeInMB, "segment " + shmName, error)) {
+        if(creator) shm_unlink(shmName.c_str());
+        return false;
+    }
+    _mayClearMapping= creator;
+    return true;
+#else
+    (void)name;
+    (void)sizeInMB;
+    error= "shared memory transposition tables are not supported on this platform";
+    return false;
+#endif
+}
+
+bool TranspositionTable::attachFile(const std::string& path, size_t sizeInMB, std::string& error) {
+#ifdef TALAWA_HAS_SHM
+    bool creator= true;
+    int fd= open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if(fd < 0 && errno == EEXIST) {
+        creator= false;
+        fd= open(path.c_str(), O_RDWR);
+    }
+    if(fd < 0) {
+        error= "open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    if(!attachMapping(fd, creator, sizeInMB, "file " + path, error)) {
+        if(creator) unlink(path.c_str());
+        return false;
+    }
+    _mayClearMapping= true;
+    return true;
+#else
+    (void)path;
+    (void)sizeInMB;
+    error= "file-backed transposition tables are not supported on this platform";
+    return false;
+#endif
+}
+
+#ifdef TALAWA_HAS_SHM
+bool TranspositionTable::attachMapping(int fd, bool creator, size_t sizeInMB, const std::string& label, std::string& error) {
+    size_t bucketCount= std::max<size_t>(1, (sizeInMB * 1024 * 1024) / sizeof(Bucket));
+    size_t bytes= sizeof(SharedHeader) + bucketCount * sizeof(Bucket);
+    if(creator) {
+        if(ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            error= std::string("ftruncate: ") + std::strerror(errno);
+            close(fd);
+            return false;
+        }
+    } else {
+        struct stat st;
+        for(int attempt= 0; attempt < 1000; ++attempt) {
+            if(fstat(fd, &st) == 0 && st.st_size > static_cast<off_t>(sizeof(SharedHeader))) break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        if(fstat(fd, &st) != 0 || st.st_size <= static_cast<off_t>(sizeof(SharedHeader))) {
+            error= label + " was never sized by its creator";
+            close(fd);
+            return false;
+        }
+        bytes= static_cast<size_t>(st.st_size); // An existing table keeps its size
+    }
+
+    void* mapping= mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd); // The mapping stays valid
+    if(mapping == MAP_FAILED) {
+        error= std::string("mmap: ") + std::strerror(errno);
+        return false;
+    }
+
+    auto* header= static_cast<SharedHeader*>(mapping);
+    if(creator) {
+        header->bucketCount= (bytes - sizeof(SharedHeader)) / sizeof(Bucket);
+        header->zobristFingerprint= core::board::Board::zobristFingerprint();
+        header->magic.store(SHARED_MAGIC, std::memory_order_release);
+    } else {
+        for(int attempt= 0; attempt < 1000 && header->magic.load(std::memory_order_acquire) == 0; ++attempt) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        // Entries hashed with other Zobrist keys would be wrong hits, not just misses
+        if(header->magic.load(std::memory_order_acquire) != SHARED_MAGIC ||
+           header->zobristFingerprint != core::board::Board::zobristFingerprint() ||
+           sizeof(SharedHeader) + header->bucketCount * sizeof(Bucket) > bytes) {
+            error= label + " is not a compatible transposition table";
+            munmap(mapping, bytes);
+            return false;
+        }
+    }
+
+    // Switch over: a fresh table is zero-filled, which reads as empty entries
+    releaseShared();
+    releaseOwned();
+    _mapping= mapping;
+    _mappingBytes= bytes;
+    _bucketCount= header->bucketCount;
+    _buckets= reinterpret_cast<Bucket*>(static_cast<char*>(mapping) + sizeof(SharedHeader));
+    return true;
+}
+#endif
+
+// Snapshot layout: FileHeader, then the buckets exactly as they are in memory
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t bucketSize;
+    uint64_t bucketCount;
+    uint64_t zobristFingerprint;
+    uint8_t generation;
+    uint8_t reserved[7];
+};
+static constexpr char FILE_MAGIC[8]= {'T', 'L', 'W', 'H', 'A', 'S', 'H', '\0'};
+static constexpr uint32_t FILE_VERSION= 1; // Entry layout of TranspositionTable::pack
+
+bool TranspositionTable::save(const std::string& path, std::string& error) const {
+    FILE* file= std::fopen(path.c_str(), "wb");
+    if(file == nullptr) {
+        error= "cannot write " + path;
+        return false;
+    }
+    FileHeader header= {};
+    std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+    header.version= FILE_VERSION;
+    header.bucketSize= sizeof(Bucket);
+    header.bucketCount= _bucketCount;
+    header.zobristFingerprint= core::board::Board::zobristFingerprint();
+    header.generation= _generation;
+    bool written= std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                  std::fwrite(static_cast<const void*>(_buckets), sizeof(Bucket), _bucketCount, file) == _bucketCount;
+    if(std::fclose(file) != 0 || !written) {
+        error= "cannot write " + path;
+        return false;
+    }
+    return true;
+}
+
+bool TranspositionTable::load(const std::string& path, std::string& error) {
+    FILE* file= std::fopen(path.c_str(), "rb");
+    if(file == nullptr) {
+        error= "cannot open " + path;
+        return false;
+    }
+    FileHeader header;
+    bool valid= false;
+    if(std::fread(&header, sizeof(header), 1, file) != 1 || std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 ||
+       header.bucketCount == 0) {
+        error= path + " is not a transposition table snapshot";
+    } else if(header.version != FILE_VERSION || header.bucketSize != sizeof(Bucket)) {
+        error= "snapshot version " + std::to_string(header.version) + " is not supported";
+    } else if(header.zobristFingerprint != core::board::Board::zobristFingerprint()) {
+        error= "snapshot was written with different Zobrist keys";
+    } else if(isShared() && header.bucketCount != _bucketCount) {
+        error= "snapshot has " + std::to_string(header.bucketCount * sizeof(Bucket) / (1024 * 1024)) +
+               " MB but the shared table has " + std::to_string(sizeInMB()) + " MB";
+    } else {
+        valid= true;
+    }
+    if(!valid) {
+        std::fclose(file);
+        return false;
+    }
+
+    // A private table takes the snapshot's size: an entry's bucket depends on the bucket count
+    if(!isShared() && header.bucketCount != _bucketCount) allocate(header.bucketCount);
+    bool complete= std::fread(static_cast<void*>(_buckets), sizeof(Bucket), _bucketCount, file) == _bucketCount;
+    std::fclose(file);
+    if(!complete) {
+        clear();
+        error= path + " is truncated";
+        return false;
+    }
+    _generation= header.generation & GENERATION_MASK;
+    return true;
+}
+
+bool TranspositionTable::clear(int threadCount) {
+    if(isShared() && !_mayClearMapping) return false;
+    // Contiguous slices, one per thread. No search of ours runs meanwhile, so plain memset is
+    // fine for a private table; a mapped one may be in use by other processes.
+    bool mapped= isShared();
+    size_t threads= std::clamp<size_t>(threadCount, 1, _bucketCount);
+    size_t slice= (_bucketCount + threads - 1) / threads;
+    auto zero= [this, slice, mapped](size_t index) {
+        size_t begin= index * slice;
+        size_t end= std::min(_bucketCount, begin + slice);
+        if(begin >= end) return;
+        if(!mapped) {
+            std::memset(static_cast<void*>(_buckets + begin), 0, (end - begin) * sizeof(Bucket));
+            return;
+        }
+        for(size_t i= begin; i < end; ++i) {
+            for(auto& entry: _buckets[i].entries) entry.store(0, std::memory_order_relaxed);
+        }
+    };
+    std::vector<std::thread> workers;
+    for(size_t i= 1; i < threads; ++i) workers.emplace_back(zero, i);
+    zero(0);
+    for(auto& worker: workers) worker.join();
+    _generation= 0;
+    _untouched= false;
+    return true;
+}
+
+void TranspositionTable::prefault() {
+    if(_untouched) clear(std::max(1u, std::thread::hardware_concurrency()));
+}
+
+// Layout, low to high: key (16) | from (6) | to (6) | promotion piece (5) | score (16) |
+// depth + 1 (8) | flag (2) | generation (5). Depth is stored biased so an all-zero word is
+// an empty entry: nothing stored has depth below 0.
+static constexpr int MOVE_SHIFT= 16;
+static constexpr int SCORE_SHIFT= 33;
+static constexpr int DEPTH_SHIFT= 49;
+static constexpr int FLAG_SHIFT= 57;
+static constexpr int GENERATION_SHIFT= 59;
+
+uint64_t TranspositionTable::pack(uint16_t key, const core::Move& bestMove, int score, int depth, TTFlag flag, uint8_t generation) {
+    uint64_t packed= key;
+    packed|= static_cast<uint64_t>(bestMove.from.ToIndex() & 63) << MOVE_SHIFT;
+    packed|= static_cast<uint64_t>(bestMove.to.ToIndex() & 63) << (MOVE_SHIFT + 6);
+    packed|= static_cast<uint64_t>(bestMove.promotion & 31) << (MOVE_SHIFT + 12);
+    packed|= static_cast<uint64_t>(static_cast<uint16_t>(static_cast<int16_t>(score))) << SCORE_SHIFT;
+    packed|= static_cast<uint64_t>(std::clamp(depth + 1, 1, 255)) << DEPTH_SHIFT;
+    packed|= static_cast<uint64_t>(flag) << FLAG_SHIFT;
+    packed|= static_cast<uint64_t>(generation) << GENERATION_SHIFT;
+    return packed;
+}
+
+void TranspositionTable::unpack(uint64_t packed, TTData& data) {
+    data.bestMove= core::Move();
+    data.bestMove.from= core::board::Coordinate::FromIndex((packed >> MOVE_SHIFT) & 63);
+    data.bestMove.to= core::board::Coordinate::FromIndex((packed >> (MOVE_SHIFT + 6)) & 63);
+    data.bestMove.promotion= static_cast<core::Piece::Piece>((packed >> (MOVE_SHIFT + 12)) & 31);
+    data.score= static_cast<int16_t>((packed >> SCORE_SHIFT) & 0xFFFF);
+    data.depth= static_cast<int>((packed >> DEPTH_SHIFT) & 0xFF) - 1;
+    data.flag= static_cast<TTFlag>((packed >> FLAG_SHIFT) & 3);
+}
+
+int TranspositionTable::hashfull() const {
+    size_t sampled= std::min<size_t>(_bucketCount, 1000 / BUCKET_ENTRIES);
+    int used= 0;
+    for(size_t i= 0; i < sampled; ++i) {
+        for(const auto& entry: _buckets[i].entries) {
+            uint64_t packed= entry.load(std::memory_order_relaxed);
+            if(packed != 0 && (packed >> GENERATION_SHIFT) == _generation) used++;
+        }
+    }
+    return static_cast<int>(used * 1000 / (sampled * BUCKET_ENTRIES));
+}
+
+bool TranspositionTable::probe(uint64_t zobristHash, TTData& data) const {
+    Bucket& b= bucket(zobristHash);
+    uint16_t key= keyOf(zobristHash);
+    for(auto& entry: b.entries) {
+        uint64_t packed= entry.load(std::memory_order_relaxed);
+        if(static_cast<uint16_t>(packed) != key || packed == 0) continue;
+        unpack(packed, data);
+        // Refresh the generation so the entry is not aged out while it is still being used
+        uint64_t generation= static_cast<uint64_t>(_generation) << GENERATION_SHIFT;
+        if((packed & (uint64_t(GENERATION_MASK) << GENERATION_SHIFT)) != generation) {
+            uint64_t refreshed= (packed & ~(uint64_t(GENERATION_MASK) << GENERATION_SHIFT)) | generation;
+            entry.compare_exchange_weak(packed, refreshed, std::memory_order_relaxed); // Losing a race is fine
+        }
+        return true;
+    }
+    data= TTData();
+    return false;
+}
+
+void TranspositionTable::store(uint64_t zobristHash, const core::Move& bestMove, int score, int depth, TTFlag flag) {
+    Bucket& b= bucket(zobristHash);
+    uint16_t key= keyOf(zobristHash);
+    std::atomic<uint64_t>* victim= &b.entries[0];
+    int victimValue= INT32_MAX;
+    for(auto& entry: b.entries) {
+        uint64_t packed= entry.load(std::memory_order_relaxed);
+        if(packed != 0 && static_cast<uint16_t>(packed) == key) {
+            victim= &entry; // Same position: always its own slot
+            break;
+        }
+        int entryDepth= static_cast<int>((packed >> DEPTH_SHIFT) & 0xFF) - 1; // -1 when empty
+        int age= (_generation - static_cast<int>(packed >> GENERATION_SHIFT)) & GENERATION_MASK;
+        int value= packed == 0 ? -1000 : entryDepth - 8 * age;
+        if(value < victimValue) {
+            victimValue= value;
+            victim= &entry;
+        }
+    }
+    victim->store(pack(key, bestMove, score, depth, flag, _generation), std::memory_order_relaxed);
+}
+
+} // namespace talawachess
@@ -0,0 +1,246 @@
+#include "Tuner.hpp"
+#include "Board.hpp"
+#include "Evaluator.hpp"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace talawachess {
+using namespace core::board;
+using namespace core::Piece;
+
+static const double LOG10_OVER_400= std::log(10.0) / 400.0;
+
+// Expected score for an evaluation in centipawns, with scaling constant k
+static double sigmoid(double k, double eval) {
+    return 1.0 / (1.0 + std::exp(-k * eval * LOG10_OVER_400));
+}
+
+Tuner::Tuner(const TunerOptions& options): _options(options) {
+    _params.assign(PARAM_COUNT, 0.0);
+    for(int type= 0; type < 7; ++type) {
+        _params[valueIndex(type)]= bot::evaluator::PieceValues[type];
+        for(int square= 0; square < 64; ++square) {
+            _params[squareIndex(type, square)]= bot::evaluator::PieceSquareTables[type][square];
+        }
+    }
+}
+
+// One piece of a packed position as the evaluator sees it: +1/-1 for white/black, the piece
+// type and the piece-square table index (mirrored for black)
+struct PieceTerm {
+    int sign;
+    int type;
+    int square;
+};
+
+static int decode(const data::PackedPosition& position, PieceTerm* terms) {
+    int count= 0;
+    for(uint64_t bits= position.occupancy; bits; bits&= bits - 1) {
+        int square= std::countr_zero(bits);
+        uint8_t code= (position.pieces[count / 2] >> (count % 2 == 0 ? 0 : 4)) & 0xF;
+        bool black= code & 8;
+        terms[count++]= {black ? -1 : 1, code & 7, black ? square ^ 56 : square};
+    }
+    return count;
+}
+
+double Tuner::evaluate(const data::PackedPosition& position, const std::vector<double>& params) const {
+    PieceTerm terms[32];
+    int count= decode(position, terms);
+    double eval= 0.0;
+    for(int i= 0; i < count; ++i) {
+        eval+= terms[i].sign * (params[valueIndex(terms[i].type)] + params[squareIndex(terms[i].type, terms[i].square)]);
+    }
+    return eval; // White's point of view, like the stored score and result
+}
+
+bool Tuner::load(std::string& error) {
+    data::DataReader reader;
+    if(!reader.open(_options.dataPath, error)) return false;
+    uint64_t count= reader.recordCount();
+    if(_options.limit > 0) count= std::min(count, _options.limit);
+    _positions.reserve(count);
+    data::PackedPosition record;
+    while(_positions.size() < count && reader.next(record)) _positions.push_back(record);
+    if(_positions.empty()) {
+        error= _options.dataPath + " has no positions";
+        return false;
+    }
+
+    // The tuner's linear model has to be exactly the engine's evaluation, or the fit is meaningless
+    Board board;
+    for(size_t i= 0; i < std::min<size_t>(_positions.size(), 1000); ++i) {
+        data::unpack(_positions[i], board);
+        int engineEval= bot::evaluator::evaluate(board) * (board.activeColor == WHITE ? 1 : -1);
+        if(engineEval != static_cast<int>(evaluate(_positions[i], _params))) {
+            error= "tuner evaluation does not match Evaluator::evaluate (position " + std::to_string(i) + ")";
+            return false;
+        }
+    }
+    return true;
+}
+
+double Tuner::loss(double k, std::vector<double>* gradient) const {
+    std::vector<double> threadLoss(_threadCount, 0.0);
+    std::vector<std::vector<double>> threadGradient(_threadCount);
+    size_t chunk= (_positions.size() + _threadCount - 1) / _threadCount;
+
+    auto work= [&](int index) {
+        std::vector<double>& grad= threadGradient[index];
+        if(gradient) grad.assign(PARAM_COUNT, 0.0);
+        size_t begin= index * chunk;
+        size_t end= std::min(_positions.size(), begin + chunk);
+        double sum= 0.0;
+        PieceTerm terms[32];
+        for(size_t i= begin; i < end; ++i) {
+            const data::PackedPosition& position= _positions[i];
+            int count= decode(position, terms);
+            double eval= 0.0;
+            for(int t= 0; t < count; ++t) {
+                eval+= terms[t].sign * (_params[valueIndex(terms[t].type)] + _params[squareIndex(terms[t].type, terms[t].square)]);
+            }
+            double target= position.result / 2.0;
+            if(_options.lambda > 0.0) target= _options.lambda * sigmoid(k, position.score) + (1.0 - _options.lambda) * target;
+            double predicted= sigmoid(k, eval);
+            double error= predicted - target;
+            sum+= error * error;
+            if(!gradient) continue;
+
+            // d(error^2)/d(eval); every parameter enters eval with coefficient +1 or -1
+            double slope= 2.0 * error * predicted * (1.0 - predicted) * k * LOG10_OVER_400;
+            for(int t= 0; t < count; ++t) {
+                grad[valueIndex(terms[t].type)]+= terms[t].sign * slope;
+                grad[squareIndex(terms[t].type, terms[t].square)]+= terms[t].sign * slope;
+            }
+        }
+        threadLoss[index]= sum;
+    };
+    std::vector<std::thread> threads;
+    for(int i= 1; i < _threadCount; ++i) threads.emplace_back(work, i);
+    work(0);
+    for(auto& thread: threads) thread.join();
+
+    double total= 0.0;
+    for(double value: threadLoss) total+= value;
+    if(gradient) {
+        gradient->assign(PARAM_COUNT, 0.0);
+        for(const auto& grad: threadGradient) {
+            for(int p= 0; p < PARAM_COUNT; ++p) (*gradient)[p]+= grad[p] / _positions.size();
+        }
+    }
+    return total / _positions.size();
+}
+
+// Scaling constant that best maps the current evaluation onto the results (golden section search)
+double Tuner::fitScalingConstant() const {
+    const double ratio= (std::sqrt(5.0) - 1.0) / 2.0;
+    double low= 0.05, high= 5.0;
+    double a= high - ratio * (high - low), b= low + ratio * (high - low);
+    double lossA= loss(a, nullptr), lossB= loss(b, nullptr);
+    for(int i= 0; i < 40; ++i) {
+        if(lossA < lossB) {
+            high= b;
+            b= a;
+            lossB= lossA;
+            a= high - ratio * (high - low);
+            lossA= loss(a, nullptr);
+        } else {
+            low= a;
+            a= b;
+            lossA= lossB;
+            b= low + ratio * (high - low);
+            lossB= loss(b, nullptr);
+        }
+    }
+    return (low + high) / 2.0;
+}
+
+bool Tuner::writeHeader(std::string& error) const {
+    static const char* TYPE_NAMES[7]= {"NONE", "PAWN", "KNIGHT", "BISHOP", "ROOK", "QUEEN", "KING"};
+    std::ostringstream out;
+    out << "#pragma once\n"
+        << "#include <array>\n"
+        << "// Evaluation parameters. \"talawachess tune\" rewrites this file with fitted values.\n"
+        << "namespace talawachess::bot::evaluator {\n\n"
+        << "static constexpr int PieceValues[7]= {";
+    for(int type= 0; type < 7; ++type) out << (type ? ", " : "") << std::lround(_params[valueIndex(type)]);
+    out << "}; // NONE, PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING\n\n"
+        << "// Indexed by square (a1 = 0) from white's side; black pieces use square ^ 56\n"
+        << "// clang-format off\n"
+        << "inline constexpr std::array<std::array<int, 64>, 7> PieceSquareTables= {{\n";
+    for(int type= 0; type < 7; ++type) {
+        out << "    {{ // " << TYPE_NAMES[type] << "\n";
+        for(int rank= 0; rank < 8; ++rank) {
+            out << "    ";
+            for(int file= 0; file < 8; ++file) {
+                out << std::setw(4) << std::lround(_params[squareIndex(type, rank * 8 + file)]) << (rank * 8 + file < 63 ? "," : " ");
+            }
+            out << " // Rank " << rank + 1 << "\n";
+        }
+        out << "    }}" << (type < 6 ? "," : "") << "\n";
+    }
+    out << "}};\n"
+        << "// clang-format on\n\n"
+        << "} // namespace talawachess::bot::evaluator\n";
+
+    std::ofstream file(_options.outputPath);
+    if(!file || !(file << out.str())) {
+        error= "cannot write " + _options.outputPath;
+        return false;
+    }
+    return true;
+}
+
+int Tuner::run() {
+    _threadCount= _options.threads > 0 ? _options.threads : std::max(1u, std::thread::hardware_concurrency());
+    std::string error;
+    auto loadStart= std::chrono::steady_clock::now();
+    if(!load(error)) {
+        std::cerr << "tune: " << error << std::endl;
+        return 1;
+    }
+    double loadSeconds= std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+    std::cout << "tune: " << _positions.size() << " positions (" << _positions.size() * sizeof(data::PackedPosition) / (1024 * 1024)
+              << " MB) loaded in " << std::fixed << std::setprecision(2) << loadSeconds << "s, " << _threadCount << " threads"
+              << std::endl;
+
+    double k= fitScalingConstant();
+    std::cout << "tune: K " << std::setprecision(4) << k << ", initial loss " << std::setprecision(6) << loss(k, nullptr) << std::endl;
+
+    // Adam
+    const double beta1= 0.9, beta2= 0.999, epsilon= 1e-8;
+    std::vector<double> gradient, moment(PARAM_COUNT, 0.0), velocity(PARAM_COUNT, 0.0);
+    auto start= std::chrono::steady_clock::now();
+    for(int epoch= 1; epoch <= _options.epochs; ++epoch) {
+        double current= loss(k, &gradient);
+        for(int p= 0; p < PARAM_COUNT; ++p) {
+            moment[p]= beta1 * moment[p] + (1.0 - beta1) * gradient[p];
+            velocity[p]= beta2 * velocity[p] + (1.0 - beta2) * gradient[p] * gradient[p];
+            double momentHat= moment[p] / (1.0 - std::pow(beta1, epoch));
+            double velocityHat= velocity[p] / (1.0 - std::pow(beta2, epoch));
+            _params[p]-= _options.learningRate * momentHat / (std::sqrt(velocityHat) + epsilon);
+        }
+        if(epoch % 10 == 0 || epoch == 1 || epoch == _options.epochs) {
+            double seconds= std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cout << "epoch " << epoch << " loss " << std::setprecision(6) << current << " (" << std::setprecision(0)
+                      << epoch * _positions.size() / std::max(seconds, 1e-9) << " positions/s)" << std::endl;
+        }
+    }
+    std::cout << "tune: final loss " << std::setprecision(6) << loss(k, nullptr) << std::defaultfloat << std::endl;
+
+    if(!writeHeader(error)) {
+        std::cerr << "tune: " << error << std::endl;
+        return 1;
+    }
+    std::cout << "tune: parameters written to " << _options.outputPath << ", rebuild to use them" << std::endl;
+    return 0;
+}
+
+} // namespace talawachess
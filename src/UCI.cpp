@@ -1,81 +1,102 @@
 #include "UCI.hpp"
+#include "Bench.hpp"
+#include "Profiler.hpp"
 #include "Coordinate.hpp"
 #include "MoveGenerator.hpp"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
 #include <random>
 #include <sstream>
 
-#ifdef _WIN32
-#include <windows.h>
-#else
-#include <sys/select.h>
-#include <unistd.h>
-#endif
-
 namespace talawachess {
 
-// Non-blocking check if input is available on stdin
-static bool inputAvailable() {
-#ifdef _WIN32
-    static HANDLE hStdin= GetStdHandle(STD_INPUT_HANDLE);
-    static bool isPipe= (GetFileType(hStdin) == FILE_TYPE_PIPE);
-    if(isPipe) {
-        DWORD bytesAvailable= 0;
-        if(!PeekNamedPipe(hStdin, nullptr, 0, nullptr, &bytesAvailable, nullptr)) {
-            return true; // Pipe broken (GUI closed), signal as input available to trigger EOF
-        }
-        return bytesAvailable > 0;
-    } else {
-        DWORD events= 0;
-        if(!GetNumberOfConsoleInputEvents(hStdin, &events) || events < 2) return false;
-        // Check if any of the events are key presses
-        INPUT_RECORD record;
-        DWORD read;
-        while(events > 0) {
-            PeekConsoleInput(hStdin, &record, 1, &read);
-            if(record.EventType == KEY_EVENT && record.Event.KeyEvent.bKeyDown) return true;
-            // Discard non-key events
-            ReadConsoleInput(hStdin, &record, 1, &read);
-            events--;
+// Input thread: reads stdin line by line so the engine never blocks (or polls) on it.
+// End of input (GUI closed the pipe) is turned into a "quit" command.
+void UCI::readInput() {
+    std::string line;
+    while(true) {
+        bool gotLine= static_cast<bool>(std::getline(std::cin, line));
+        if(!gotLine) line= "quit";
+        {
+            std::lock_guard<std::mutex> lock(_commandsMutex);
+            _commands.push_back(line);
         }
-        return false;
+        _commandsAvailable.notify_one();
+        if(!gotLine || line == "quit") return;
     }
-#else
-    fd_set readfds;
-    FD_ZERO(&readfds);
-    FD_SET(STDIN_FILENO, &readfds);
-    struct timeval tv= {0, 0};
-    return select(1, &readfds, nullptr, nullptr, &tv) > 0;
-#endif
 }
 
-// Buffer for pending input line
-static std::string pendingInput;
-static bool stopRequested= false;
-
-// Check if stop command was received (called by bot during search)
-static bool checkForStop() {
-    if(stopRequested) return true;
-    if(inputAvailable()) {
-        std::string line;
-        if(std::getline(std::cin, line)) {
-            if(line == "stop" || line == "quit") {
-                stopRequested= true;
-                return true;
-            }
-            // Store other commands for later processing
-            pendingInput= line;
+std::string UCI::nextCommand() {
+    std::unique_lock<std::mutex> lock(_commandsMutex);
+    _commandsAvailable.wait(lock, [this] { return !_commands.empty(); });
+    std::string command= _commands.front();
+    _commands.pop_front();
+    return command;
+}
+
+// Whole-string decimal integer, without throwing on bad GUI input
+static bool parseInt(const std::string& text, int& out) {
+    const char* end= text.data() + text.size();
+    auto [ptr, ec]= std::from_chars(text.data(), end, out);
+    return ec == std::errc() && ptr == end && !text.empty();
+}
+
+// Signals a running search to stop (it still prints its bestmove) and waits for it
+void UCI::stopSearch() {
+    _bot.stopSearch();
+    _mateSolver.stop();
+    if(_searchThread.joinable()) _searchThread.join();
+}
+
+// Runs on the search thread: think, then report the move
+void UCI::runSearch(SearchLimits limits) {
+    if(limits.mate > 0) {
+        // Under a clock, the solver and the fallback search share the budget a normal move gets
+        if(limits.movetime == 0 && limits.hasClock() && !limits.infinite) {
+            // As an ordinary clocked move: TimeManager leaves mate searches unlimited
+            SearchLimits clockLimits= limits;
+            clockLimits.mate= 0;
+            TimeManager timeManager;
+            timeManager.init(clockLimits, _bot.getBoard().activeColor, _bot.getMoveOverhead());
+            limits.movetime= std::max(1, timeManager.softLimitMs());
+        }
+        // Dedicated proof-number mate solver first
+        auto mateStart= std::chrono::steady_clock::now();
+        auto mate= _mateSolver.solve(_bot.getBoard(), limits.mate, limits.movetime);
+        if(mate.found && !mate.pv.empty()) {
+            std::string ponder= mate.pv.size() >= 2 ? " ponder " + mate.pv[1].ToString() : "";
+            std::cout << "bestmove " + mate.pv.front().ToString() + ponder + "\n" << std::flush;
+            return;
+        }
+        // No forced mate: fall back to a regular search for a move to play
+        int mateElapsedMs= std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - mateStart).count();
+        if(mate.stopped) {
+            // Also when "stop" interrupted the solver: the bot's stop flag is set as well, so the
+            // search returns at once with the first legal root move
+            limits.depth= 1;
+        } else if(limits.movetime > 0) {
+            limits.movetime= std::max(1, limits.movetime - mateElapsedMs);
         } else {
-            // EOF - pipe closed (GUI exited), stop immediately
-            stopRequested= true;
-            return true;
+            limits.depth= 2 * limits.mate;
         }
+        limits.mate= 0;
     }
-    // Also check if stdin has hit EOF (pipe broken)
-    if(std::cin.eof()) {
-        stopRequested= true;
-        return true;
+
+    auto result= _bot.getBestMove(limits);
+    auto bestMove= result.first;
+    const core::Move& ponderMove= _bot.getPonderMove();
+    std::string ponder= ponderMove.from == ponderMove.to ? "" : " ponder " + ponderMove.ToString();
+    std::string telemetry= _bot.getTelemetry().endSearch();
+    if(_searchStats == "info") telemetry+= _bot.getSearchReport().toInfoString();
+    else if(_searchStats == "json") telemetry+= "info string stats json " + _bot.getSearchReport().toJson() + "\n";
+    if(profile::ENABLED) { // Instrumented builds: where this search spent its time
+        telemetry+= profile::report();
+        profile::reset();
     }
-    return false;
+    // "0000" is the UCI null move: checkmate or stalemate, nothing to play
+    std::string move= bestMove.from == bestMove.to ? "0000" : bestMove.ToString();
+    std::cout << telemetry + "bestmove " + move + ponder + "\n" << std::flush;
 }
 
 void UCI::listen() {
@@ -85,24 +106,146 @@ void UCI::listen() {
     // Check for "startpos" initialization
     _bot.setFen(core::board::Board::STARTING_POS);
 
-    // Set up input checker for the bot to poll during search
-    _bot.setInputChecker(checkForStop);
+    _inputThread= std::thread(&UCI::readInput, this);
 
-    while(std::getline(std::cin, line)) {
+    while(true) {
+        line= nextCommand();
         std::stringstream ss(line);
+        token.clear();
         ss >> token;
 
         if(token == "uci") {
             std::cout << "id name " << ENGINE_NAME << "\n";
             std::cout << "id author Orville\n";
+            std::cout << "option name Move Overhead type spin default 30 min 0 max 5000\n";
+            std::cout << "option name Threads type spin default 1 min 1 max 512\n";
+            std::cout << "option name Hash type spin default " << Bot::DEFAULT_HASH_MB << " min 1 max 65536\n";
+            std::cout << "option name Clear Hash type button\n";
+            std::cout << "option name SharedHash type string default <empty>\n";
+            std::cout << "option name HashFile type string default <empty>\n";
+            std::cout << "option name MultiPV type spin default 1 min 1 max 256\n";
+            std::cout << "option name MateChecksOnly type check default false\n";
+            std::cout << "option name SearchStats type combo default off var off var info var json\n";
+            std::cout << "option name TraceFile type string default <empty>\n";
             std::cout << "uciok" << std::endl;
         } else if(token == "isready") {
-            std::cout << "readyok" << std::endl;
+            // Answered right away, even while a search is running. Otherwise a new TT gets its
+            // memory now, before readyok, instead of page faulting through the first timed move.
+            if(!_searchThread.joinable()) _bot.prefaultHash();
+            std::cout << "readyok\n" << std::flush;
         } else if(token == "quit") {
+            stopSearch();
             break;
         } else if(token == "stop") {
-            // Stop is handled during search via polling, ignore here
+            stopSearch();
+        } else if(token == "ucinewgame") {
+            // Nothing learned in the previous game carries over, except a SharedHash or HashFile
+            // table, which is there to keep its entries (only "Clear Hash" empties it).
+            // Telemetry is collected per game: keep the finished game's summary for
+            // "telemetry last" and start over
+            stopSearch();
+            _bot.clearHash();
+            _bot.resetHeuristics();
+            _lastGameTelemetry= _bot.getTelemetry().summary();
+            _bot.getTelemetry().reset();
+        } else if(token == "telemetry") {
+            // Non-UCI: stop latency / time overshoot summary for the current game, or with
+            // "last" for the game before the last ucinewgame
+            stopSearch();
+            ss >> token;
+            std::cout << (token == "last" ? _lastGameTelemetry : _bot.getTelemetry().summary()) << std::flush;
+        } else if(token == "bench") {
+            // Non-UCI: "bench [depth] [threads] [hash]", with its own engine instance
+            stopSearch();
+            BenchOptions options;
+            ss >> options.depth >> options.threads >> options.hashMB;
+            runBench(options);
+        } else if(token == "profile") {
+            // Non-UCI: "profile [depth] [threads] [hash]", bench with the profiling breakdown
+            stopSearch();
+            BenchOptions options;
+            ss >> options.depth >> options.threads >> options.hashMB;
+            runProfile(options);
+        } else if(token == "savehash" || token == "loadhash") {
+            // Non-UCI: "savehash <file>" / "loadhash <file>", a snapshot of the TT
+            stopSearch();
+            std::string path, error;
+            std::getline(ss >> std::ws, path);
+            bool saving= token == "savehash";
+            if(path.empty()) {
+                std::cout << "info string " << token << ": missing file name\n" << std::flush;
+            } else if(saving ? _bot.saveHash(path, error) : _bot.loadHash(path, error)) {
+                std::cout << "info string " << token << ": " << _bot.getHashSize() << " MB " << (saving ? "written to " : "read from ")
+                          << path << "\n"
+                          << std::flush;
+            } else {
+                std::cout << "info string " << token << ": " << error << "\n" << std::flush;
+            }
+        } else if(token == "ponderhit") {
+            // The expected move was played: keep searching, now on our own clock
+            _bot.ponderhit();
+        } else if(token == "setoption") {
+            stopSearch();
+            // Format: "setoption name <id> [value <x>]"
+            std::string name, value;
+            ss >> token; // "name"
+            while(ss >> token && token != "value") name+= (name.empty() ? "" : " ") + token;
+            ss >> value;
+            // Spin options need an integer: anything else is reported and ignored
+            int spin= 0;
+            bool isSpin= name == "Hash" || name == "MultiPV" || name == "Threads" || name == "Move Overhead";
+            if(isSpin && !parseInt(value, spin)) {
+                std::cout << "info string " + name + ": '" + value + "' is not an integer\n" << std::flush;
+            } else if(name == "MateChecksOnly") {
+                _mateSolver.setChecksOnly(value == "true");
+            } else if(name == "SearchStats") {
+                // Per-search counters (nodes, TT, cutoffs, reductions, branching factor) after each search
+                if(value == "off" || value == "info" || value == "json") _searchStats= value;
+            } else if(name == "SharedHash") {
+                // Name of a POSIX shared-memory segment for the TT, shared with other engine processes
+                std::string error;
+                if(value == "<empty>") value.clear();
+                if(!_bot.setSharedHash(value, error)) {
+                    std::cout << "info string SharedHash: " + error + ", keeping the private table\n" << std::flush;
+                } else if(!value.empty()) {
+                    std::cout << "info string SharedHash attached to " + value + "\n" << std::flush;
+                }
+            } else if(name == "HashFile") {
+                // TT kept in a file across runs: a restarted analysis starts from the old entries
+                std::string error;
+                if(value == "<empty>") value.clear();
+                if(!_bot.setHashFile(value, error)) {
+                    std::cout << "info string HashFile: " + error + ", keeping the current table\n" << std::flush;
+                } else if(!value.empty()) {
+                    std::cout << "info string HashFile attached to " + value + "\n" << std::flush;
+                }
+            } else if(name == "TraceFile") {
+                // Binary record of every main-search node, read with talawachess_trace
+                std::string error;
+                if(value == "<empty>") value.clear();
+                if(!_bot.setTraceFile(value, error)) {
+                    std::cout << "info string TraceFile: " + error + "\n" << std::flush;
+                } else if(!value.empty()) {
+                    std::cout << "info string TraceFile writing to " + value + "\n" << std::flush;
+                }
+            } else if(name == "Hash") {
+                std::string error;
+                if(!_bot.setHashSize(std::clamp(spin, 1, 65536), error)) {
+                    std::cout << "info string Hash: " + error + "\n" << std::flush;
+                }
+            } else if(name == "Clear Hash") {
+                // Unlike ucinewgame, also empties a SharedHash or HashFile table
+                std::string error;
+                if(!_bot.clearSharedHash(error)) std::cout << "info string Clear Hash: " + error + "\n" << std::flush;
+            } else if(name == "MultiPV") {
+                _bot.setMultiPV(spin);
+            } else if(name == "Threads") {
+                _bot.setThreads(std::clamp(spin, 1, 512));
+            } else if(name == "Move Overhead") {
+                _bot.setMoveOverhead(spin);
+            }
         } else if(token == "position") {
+            stopSearch();
             // Format: "position startpos moves e2e4 e7e5 ..."
             std::string posType;
             ss >> posType;
@@ -130,56 +273,33 @@ void UCI::listen() {
 
             // _bot.getBoard().print(); // DEBUG: Print the board before thinking
             // "go" asks the engine to start thinking.
-            // 1. Initialize variables with default values
-            int wtime= 0;      // White time remaining (ms)
-            int btime= 0;      // Black time remaining (ms)
-            int winc= 0;       // White increment (ms)
-            int binc= 0;       // Black increment (ms)
-            int movestogo= 30; // Default moves to go if not specified
-            int movetime= 0;   // Fixed move time (ms), if specified
-
-            // 2. Parse the line to find time parameters
-            bool infinite= false;
-            int maxDepth= 0;
+            // 1. Parse the line to find time parameters (the TimeManager turns them into limits)
+            SearchLimits limits;
             std::string type;
             while(ss >> type) {
-                if(type == "wtime") ss >> wtime;
-                else if(type == "btime") ss >> btime;
-                else if(type == "winc") ss >> winc;
-                else if(type == "binc") ss >> binc;
-                else if(type == "movestogo") ss >> movestogo;
-                else if(type == "movetime") ss >> movetime;
-                else if(type == "infinite") infinite= true;
-                else if(type == "depth") ss >> maxDepth;
-            }
-
-            // 3. Determine "Our" time
-            int myTime= (_bot.getBoard().activeColor == core::Piece::WHITE) ? wtime : btime;
-            int myInc= (_bot.getBoard().activeColor == core::Piece::WHITE) ? winc : binc;
-
-            // 4. Calculate allocated time
-            int timeToThink= 0; // 0 means no time limit (infinite or depth-only)
-            if(movetime > 0) {
-                timeToThink= movetime;
-            } else if(!infinite && maxDepth == 0 && myTime > 0) {
-                // Time control: use fraction of remaining time + portion of increment
-                timeToThink= (myTime / movestogo) + (myInc / 2);
-                // Safety buffer: leave at least 50ms on the clock
-                if(timeToThink >= myTime) timeToThink= myTime - 50;
-                if(timeToThink < 10) timeToThink= 10; // Minimum time
-            } else if(!infinite && maxDepth == 0) {
-                // No time info and not infinite/depth - default to 5 seconds
-                timeToThink= 5000;
+                if(type == "wtime") ss >> limits.wtime;
+                else if(type == "btime") ss >> limits.btime;
+                else if(type == "winc") ss >> limits.winc;
+                else if(type == "binc") ss >> limits.binc;
+                else if(type == "movestogo") ss >> limits.movestogo;
+                else if(type == "movetime") ss >> limits.movetime;
+                else if(type == "infinite") limits.infinite= true;
+                else if(type == "ponder") limits.ponder= true;
+                else if(type == "depth") ss >> limits.depth;
+                else if(type == "nodes") ss >> limits.nodes;
+                else if(type == "mate") ss >> limits.mate;
             }
 
-            // Reset stop flag before search
-            stopRequested= false;
-
-            // Run search (will poll for stop command internally)
-            auto result= _bot.getBestMove(timeToThink, maxDepth);
-            auto bestMove= result.first;
-            std::cout << "bestmove " << bestMove.ToString() << std::endl;
+            // Only one search at a time; the stop flag and the ponder state are set before the
+            // thread exists, so a "stop" or "ponderhit" right after "go" can never be lost.
+            stopSearch();
+            _bot.clearStop();
+            _bot.setPondering(limits.ponder);
+            _mateSolver.clearStop();
+            _searchThread= std::thread(&UCI::runSearch, this, limits);
         }
     }
+
+    if(_inputThread.joinable()) _inputThread.join();
 }
 } // namespace talawachess
\ No newline at end of file
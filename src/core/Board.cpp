@@ -1,7 +1,9 @@
 #include "Board.hpp"
 #include "Coordinate.hpp"
+#include "Profiler.hpp"
 #include <algorithm>
 #include <iostream>
+#include <mutex>
 #include <random>
 #include <sstream>
 
@@ -36,12 +38,15 @@ static int getPieceIndex(Piece::Piece p) {
 // BOARD IMPLEMENTATION
 // -----------------------------------------------------------------------------
 
+// Boards are created on many threads (several engines in one process), so the keys are
+// generated exactly once and every other caller waits for them
+static void ensureZobrist() {
+    static std::once_flag initialized;
+    std::call_once(initialized, Board::initZobrist);
+}
+
 Board::Board() {
-    static bool initialized= false;
-    if(!initialized) {
-        initZobrist();
-        initialized= true;
-    }
+    ensureZobrist();
     game_history.reserve(512);
     setFen(STARTING_POS);
 }
@@ -60,6 +65,18 @@ void Board::initZobrist() {
     zSide= dis(gen);
 }
 
+uint64_t Board::zobristFingerprint() {
+    ensureZobrist();
+    uint64_t fingerprint= 0;
+    auto mix= [&fingerprint](uint64_t key) { fingerprint= (fingerprint ^ key) * 0x9E3779B97F4A7C15ULL + 1; };
+    for(const auto& keys: zPiece)
+        for(uint64_t key: keys) mix(key);
+    for(uint64_t key: zEnPassant) mix(key);
+    for(uint64_t key: zCastling) mix(key);
+    mix(zSide);
+    return fingerprint;
+}
+
 uint64_t Board::calculateHash() const {
     uint64_t hash= 0;
     for(int i= 0; i < 64; ++i) {
@@ -144,6 +161,7 @@ void Board::setFen(const std::string& fen) {
 }
 
 void Board::makeMove(const Move& move) {
+    TALAWA_PROFILE_ZONE(MAKE_MOVE);
     // 1. Save History
     GameState state;
     state.move= move;
@@ -315,6 +333,7 @@ void Board::undoNullMove() {
 }
 
 void Board::undoMove() {
+    TALAWA_PROFILE_ZONE(UNDO_MOVE);
     if(game_history.empty()) return;
 
     GameState lastState= game_history.back();
@@ -3,6 +3,7 @@
 #include "Coordinate.hpp"
 #include "Move.hpp"
 #include "Piece.hpp"
+#include "Profiler.hpp"
 #include <algorithm>
 #include <vector>
 
@@ -12,6 +13,7 @@ using namespace talawachess::core;
 // --- Helper: Attack Detection ---
 // Returns true if 'square' is being attacked by 'attackerColor'
 bool MoveGenerator::isSquareAttacked(const Board& board, Coordinate square, Piece::Color attackerColor) {
+    TALAWA_PROFILE_ZONE(ATTACKS);
     // 1. Check for Knight attacks (If a knight is on a square a knight would jump to)
     for(const auto& dir: KNIGHT_DIRS) {
         Coordinate target= square + dir;
@@ -81,6 +83,7 @@ bool MoveGenerator::isSquareAttacked(const Board& board, Coordinate square, Piec
 }
 
 void MoveGenerator::generateMoves(MoveList& moveList) {
+    TALAWA_PROFILE_ZONE(MOVEGEN);
     for(int i= 0; i < 64; ++i) {
         auto piece= _board.squares[i];
         if(piece == Piece::NONE) continue;
@@ -0,0 +1,220 @@
+#include "Notation.hpp"
+#include <cctype>
+#include <cstdlib>
+#include <sstream>
+
+namespace talawachess::core::board::notation {
+
+void generateLegalMoves(Board& board, MoveList& legalMoves) {
+    MoveList moves;
+    MoveGenerator moveGen(board);
+    moveGen.generateMoves(moves);
+    legalMoves.clear();
+    for(const auto& move: moves) {
+        board.makeMove(move);
+        if(MoveGenerator::IsLegalPosition(board)) legalMoves.push_back(move);
+        board.undoMove();
+    }
+}
+
+// Rejects FENs the board parser would silently turn into nonsense: 8 ranks of 8 squares,
+// one king per side and a valid side to move.
+bool validateFen(const std::string& fen, std::string& error) {
+    std::istringstream ss(fen);
+    std::string boardPart, side;
+    ss >> boardPart >> side;
+    int ranks= 1, files= 0, whiteKings= 0, blackKings= 0;
+    for(char c: boardPart) {
+        if(c == '/') {
+            if(files != 8) break;
+            ranks++;
+            files= 0;
+        } else if(c >= '1' && c <= '8') {
+            files+= c - '0';
+        } else if(std::string("pnbrqkPNBRQK").find(c) != std::string::npos) {
+            files++;
+            whiteKings+= (c == 'K');
+            blackKings+= (c == 'k');
+        } else {
+            files= 99; // Invalid character
+        }
+        if(files > 8) break;
+    }
+    if(ranks != 8 || files != 8) {
+        error= "invalid FEN board: " + fen;
+        return false;
+    }
+    if(whiteKings != 1 || blackKings != 1) {
+        error= "FEN needs exactly one king per side: " + fen;
+        return false;
+    }
+    if(side != "w" && side != "b") {
+        error= "invalid side to move in FEN: " + fen;
+        return false;
+    }
+    return true;
+}
+
+static char pieceLetter(Piece::PieceType type) {
+    switch(type) {
+    case Piece::KNIGHT: return 'N';
+    case Piece::BISHOP: return 'B';
+    case Piece::ROOK: return 'R';
+    case Piece::QUEEN: return 'Q';
+    case Piece::KING: return 'K';
+    default: return 0;
+    }
+}
+
+static bool sideToMoveInCheck(const Board& board) {
+    Coordinate kingPos= (board.activeColor == Piece::WHITE) ? board.whiteKingPos : board.blackKingPos;
+    Piece::Color opponent= (board.activeColor == Piece::WHITE) ? Piece::BLACK : Piece::WHITE;
+    return MoveGenerator::isSquareAttacked(board, kingPos, opponent);
+}
+
+std::string toSan(Board& board, const Move& move) {
+    Piece::PieceType type= Piece::GetPieceType(move.movedPiece);
+    std::string san;
+
+    if(type == Piece::KING && std::abs(move.to.file - move.from.file) == 2) {
+        san= move.to.file > move.from.file ? "O-O" : "O-O-O";
+    } else if(type == Piece::PAWN) {
+        if(move.captured != Piece::NONE) san+= static_cast<char>('a' + move.from.file);
+        if(move.captured != Piece::NONE) san+= 'x';
+        san+= move.to.toAlgebraic();
+        if(move.promotion != Piece::NONE) {
+            san+= '=';
+            san+= pieceLetter(Piece::GetPieceType(move.promotion));
+        }
+    } else {
+        san+= pieceLetter(type);
+
+        // Disambiguation: other pieces of the same type that can also reach the target square
+        MoveList legalMoves;
+        generateLegalMoves(board, legalMoves);
+        bool ambiguous= false, sameFile= false, sameRank= false;
+        for(const auto& other: legalMoves) {
+            if(other.movedPiece != move.movedPiece || !(other.to == move.to) || other.from == move.from) continue;
+            ambiguous= true;
+            if(other.from.file == move.from.file) sameFile= true;
+            if(other.from.rank == move.from.rank) sameRank= true;
+        }
+        if(ambiguous) {
+            if(!sameFile) {
+                san+= static_cast<char>('a' + move.from.file);
+            } else if(!sameRank) {
+                san+= static_cast<char>('1' + move.from.rank);
+            } else {
+                san+= move.from.toAlgebraic();
+            }
+        }
+        if(move.captured != Piece::NONE) san+= 'x';
+        san+= move.to.toAlgebraic();
+    }
+
+    board.makeMove(move);
+    if(sideToMoveInCheck(board)) {
+        MoveList replies;
+        generateLegalMoves(board, replies);
+        san+= replies.empty() ? '#' : '+';
+    }
+    board.undoMove();
+    return san;
+}
+
+static Piece::PieceType pieceFromLetter(char c) {
+    switch(c) {
+    case 'N': return Piece::KNIGHT;
+    case 'B': return Piece::BISHOP;
+    case 'R': return Piece::ROOK;
+    case 'Q': return Piece::QUEEN;
+    case 'K': return Piece::KING;
+    default: return Piece::NONE;
+    }
+}
+
+bool parseSan(Board& board, std::string_view text, Move& move) {
+    // Drop everything SAN writers disagree on: annotations, check marks and "e.p."
+    size_t enPassant= text.find("e.p.");
+    if(enPassant != std::string_view::npos) text= text.substr(0, enPassant);
+    while(!text.empty() && (text.back() == '+' || text.back() == '#' || text.back() == '!' || text.back() == '?')) {
+        text.remove_suffix(1);
+    }
+    if(text.empty()) return false;
+
+    MoveList legalMoves;
+    generateLegalMoves(board, legalMoves);
+
+    // Castling, also written with zeros
+    if(text == "O-O" || text == "0-0" || text == "O-O-O" || text == "0-0-0") {
+        bool kingSide= text.size() == 3;
+        for(const auto& candidate: legalMoves) {
+            if(Piece::GetPieceType(candidate.movedPiece) != Piece::KING || std::abs(candidate.to.file - candidate.from.file) != 2) continue;
+            if((candidate.to.file > candidate.from.file) == kingSide) {
+                move= candidate;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    Piece::PieceType type= pieceFromLetter(text[0]);
+    if(type != Piece::NONE) {
+        text.remove_prefix(1);
+    } else {
+        type= Piece::PAWN;
+    }
+
+    // What is left: [file][rank][x]square[[=]promotion]; capture marks and '=' are optional
+    char chars[8];
+    int count= 0;
+    for(char c: text) {
+        if(c == 'x' || c == ':' || c == '-' || c == '=') continue;
+        if(count == 8) return false;
+        chars[count++]= c;
+    }
+    Piece::PieceType promotion= Piece::NONE;
+    if(type == Piece::PAWN && count >= 3 && std::isdigit(static_cast<unsigned char>(chars[count - 2]))) {
+        promotion= pieceFromLetter(std::toupper(static_cast<unsigned char>(chars[count - 1])));
+        if(promotion == Piece::NONE || promotion == Piece::KING) return false;
+        count--;
+    }
+    if(count < 2 || count > 4) return false;
+    int toFile= chars[count - 2] - 'a', toRank= chars[count - 1] - '1';
+    if(toFile < 0 || toFile > 7 || toRank < 0 || toRank > 7) return false;
+    int fromFile= -1, fromRank= -1;
+    for(int i= 0; i < count - 2; ++i) {
+        if(chars[i] >= 'a' && chars[i] <= 'h') fromFile= chars[i] - 'a';
+        else if(chars[i] >= '1' && chars[i] <= '8') fromRank= chars[i] - '1';
+        else return false;
+    }
+
+    int matches= 0;
+    for(const auto& candidate: legalMoves) {
+        if(Piece::GetPieceType(candidate.movedPiece) != type) continue;
+        if(candidate.to.file != toFile || candidate.to.rank != toRank) continue;
+        if((fromFile >= 0 && candidate.from.file != fromFile) || (fromRank >= 0 && candidate.from.rank != fromRank)) continue;
+        Piece::PieceType candidatePromotion= Piece::GetPieceType(candidate.promotion);
+        Piece::PieceType wanted= promotion;
+        if(wanted == Piece::NONE && candidatePromotion != Piece::NONE) wanted= Piece::QUEEN; // "e8" means a queen
+        if(candidatePromotion != wanted) continue;
+        move= candidate;
+        matches++;
+    }
+    return matches == 1;
+}
+
+bool parseMove(Board& board, const std::string& text, Move& move) {
+    // UCI long algebraic
+    MoveList legalMoves;
+    generateLegalMoves(board, legalMoves);
+    for(const auto& candidate: legalMoves) {
+        if(candidate.ToString() == text) {
+            move= candidate;
+            return true;
+        }
+    }
+    return parseSan(board, text, move);
+}
+
+} // namespace talawachess::core::board::notation
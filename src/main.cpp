@@ -1,14 +1,247 @@
+#include "AnalysisServer.hpp"
+#include "Annotator.hpp"
+#include "Bench.hpp"
 #include "Board.hpp"
+#include "DataGenerator.hpp"
+#include "EpdRunner.hpp"
 #include "MoveGenerator.hpp"
+#include "SelfPlay.hpp"
+#include "Tuner.hpp"
 #include "UCI.hpp"
 #include <chrono>
 #include <iostream>
 #include <random>
+#include <string>
 #include <unordered_map>
 
 using namespace talawachess::core;
 using namespace talawachess::core::board;
-int main() {
+
+// talawachess serve [--socket PATH | --port N] [--workers N] [--hash MB] [--shared-hash]
+static int runServer(int argc, char* argv[]) {
+    talawachess::ServerOptions options;
+    for(int i= 2; i < argc; ++i) {
+        std::string arg= argv[i];
+        bool hasValue= i + 1 < argc;
+        if(arg == "--socket" && hasValue) options.socketPath= argv[++i];
+        else if(arg == "--port" && hasValue) options.port= std::stoi(argv[++i]);
+        else if(arg == "--workers" && hasValue) options.workers= std::stoi(argv[++i]);
+        else if(arg == "--hash" && hasValue) options.hashMB= std::stoul(argv[++i]);
+        else if(arg == "--shared-hash") options.sharedHash= true;
+        else {
+            std::cerr << "usage: talawachess serve [--socket PATH | --port N] [--workers N] [--hash MB] [--shared-hash]" << std::endl;
+            return 1;
+        }
+    }
+    if(options.socketPath.empty() && options.port == 0) {
+        std::cerr << "serve: give --socket PATH or --port N" << std::endl;
+        return 1;
+    }
+    talawachess::AnalysisServer server(options);
+    return server.run();
+}
+
+// talawachess epd FILE [--workers N] [--movetime MS] [--stable MS] [--hash MB] [--label NAME] [--csv PATH]
+static int runEpd(int argc, char* argv[]) {
+    talawachess::EpdOptions options;
+    for(int i= 2; i < argc; ++i) {
+        std::string arg= argv[i];
+        bool hasValue= i + 1 < argc;
+        if(arg == "--workers" && hasValue) options.workers= std::stoi(argv[++i]);
+        else if(arg == "--movetime" && hasValue) options.movetimeMs= std::stoi(argv[++i]);
+        else if(arg == "--stable" && hasValue) options.stableMs= std::stoi(argv[++i]);
+        else if(arg == "--hash" && hasValue) options.hashMB= std::stoul(argv[++i]);
+        else if(arg == "--label" && hasValue) options.label= argv[++i];
+        else if(arg == "--csv" && hasValue) options.csvPath= argv[++i];
+        else if(options.path.empty() && arg[0] != '-') options.path= arg;
+        else {
+            std::cerr << "usage: talawachess epd FILE [--workers N] [--movetime MS] [--stable MS] [--hash MB] [--label NAME] [--csv PATH]" << std::endl;
+            return 1;
+        }
+    }
+    if(options.path.empty()) {
+        std::cerr << "epd: no EPD file given" << std::endl;
+        return 1;
+    }
+    talawachess::EpdRunner runner(options);
+    return runner.run();
+}
+
+// talawachess selfplay [--dev PARAMS] [--base PARAMS] [--openings FILE] [--tc BASE+INC] [--concurrency N] ...
+// PARAMS are SearchParams as "name=value,...", the time control is in seconds ("2+0.02")
+static int runSelfPlay(int argc, char* argv[]) {
+    talawachess::SelfPlayOptions options;
+    for(int i= 2; i < argc; ++i) {
+        std::string arg= argv[i];
+        bool hasValue= i + 1 < argc;
+        if(arg == "--dev" && hasValue) options.devParams= argv[++i];
+        else if(arg == "--base" && hasValue) options.baseParams= argv[++i];
+        else if(arg == "--openings" && hasValue) options.openingsPath= argv[++i];
+        else if(arg == "--plies" && hasValue) options.openingPlies= std::stoi(argv[++i]);
+        else if(arg == "--games" && hasValue) options.games= std::stoi(argv[++i]);
+        else if(arg == "--concurrency" && hasValue) options.concurrency= std::stoi(argv[++i]);
+        else if(arg == "--hash" && hasValue) options.hashMB= std::stoul(argv[++i]);
+        else if(arg == "--elo0" && hasValue) options.elo0= std::stod(argv[++i]);
+        else if(arg == "--elo1" && hasValue) options.elo1= std::stod(argv[++i]);
+        else if(arg == "--alpha" && hasValue) options.alpha= std::stod(argv[++i]);
+        else if(arg == "--beta" && hasValue) options.beta= std::stod(argv[++i]);
+        else if(arg == "--resign-score" && hasValue) options.resignScore= std::stoi(argv[++i]);
+        else if(arg == "--resign-moves" && hasValue) options.resignMoves= std::stoi(argv[++i]);
+        else if(arg == "--draw-score" && hasValue) options.drawScore= std::stoi(argv[++i]);
+        else if(arg == "--draw-moves" && hasValue) options.drawMoves= std::stoi(argv[++i]);
+        else if(arg == "--draw-after" && hasValue) options.drawMoveNumber= std::stoi(argv[++i]);
+        else if(arg == "--tc" && hasValue) {
+            std::string tc= argv[++i];
+            size_t plus= tc.find('+');
+            options.baseTimeMs= static_cast<int>(std::stod(tc.substr(0, plus)) * 1000);
+            options.incrementMs= plus == std::string::npos ? 0 : static_cast<int>(std::stod(tc.substr(plus + 1)) * 1000);
+        } else {
+            std::cerr << "usage: talawachess selfplay [--dev PARAMS] [--base PARAMS] [--openings FILE.epd|FILE.pgn] [--plies N]\n"
+                      << "    [--games N] [--concurrency N] [--tc BASE+INC] [--hash MB] [--elo0 E] [--elo1 E] [--alpha A] [--beta B]\n"
+                      << "    [--resign-score CP] [--resign-moves N] [--draw-score CP] [--draw-moves N] [--draw-after MOVE]" << std::endl;
+            return 1;
+        }
+    }
+    talawachess::SelfPlay match(options);
+    return match.run();
+}
+
+// talawachess datagen [--out FILE] [--positions N] [--threads N] [--depth D | --nodes N] [--random-plies N] [--hash MB] [--seed S]
+static int runDataGen(int argc, char* argv[]) {
+    talawachess::DataGenOptions options;
+    for(int i= 2; i < argc; ++i) {
+        std::string arg= argv[i];
+        bool hasValue= i + 1 < argc;
+        if(arg == "--out" && hasValue) options.outputPath= argv[++i];
+        else if(arg == "--positions" && hasValue) options.positions= std::stoull(argv[++i]);
+        else if(arg == "--threads" && hasValue) options.threads= std::stoi(argv[++i]);
+        else if(arg == "--depth" && hasValue) options.depth= std::stoi(argv[++i]);
+        else if(arg == "--nodes" && hasValue) options.nodes= std::stoull(argv[++i]);
+        else if(arg == "--random-plies" && hasValue) options.randomPlies= std::stoi(argv[++i]);
+        else if(arg == "--hash" && hasValue) options.hashMB= std::stoul(argv[++i]);
+        else if(arg == "--seed" && hasValue) options.seed= std::stoull(argv[++i]);
+        else {
+            std::cerr << "usage: talawachess datagen [--out FILE] [--positions N] [--threads N] [--depth D | --nodes N] [--random-plies N] [--hash MB] [--seed S]" << std::endl;
+            return 1;
+        }
+    }
+    talawachess::DataGenerator generator(options);
+    return generator.run();
+}
+
+// talawachess datainfo FILE: streams a datagen file and prints what is in it
+static int runDataInfo(int argc, char* argv[]) {
+    if(argc < 3) {
+        std::cerr << "usage: talawachess datainfo FILE" << std::endl;
+        return 1;
+    }
+    talawachess::data::DataReader reader;
+    std::string error;
+    if(!reader.open(argv[2], error)) {
+        std::cerr << "datainfo: " << error << std::endl;
+        return 1;
+    }
+    uint64_t count= 0, results[3]= {0, 0, 0}, absScore= 0;
+    talawachess::data::PackedPosition record;
+    while(reader.next(record)) {
+        count++;
+        results[std::min<int>(record.result, 2)]++;
+        absScore+= std::abs(record.score);
+    }
+    std::cout << count << " positions, white wins " << results[2] << ", draws " << results[1] << ", black wins " << results[0]
+              << ", mean |score| " << (count ? absScore / count : 0) << std::endl;
+    return 0;
+}
+
+// talawachess tune DATA [--out HEADER] [--epochs N] [--lr X] [--lambda L] [--threads N] [--limit N]
+static int runTune(int argc, char* argv[]) {
+    talawachess::TunerOptions options;
+    for(int i= 2; i < argc; ++i) {
+        std::string arg= argv[i];
+        bool hasValue= i + 1 < argc;
+        if(arg == "--out" && hasValue) options.outputPath= argv[++i];
+        else if(arg == "--epochs" && hasValue) options.epochs= std::stoi(argv[++i]);
+        else if(arg == "--lr" && hasValue) options.learningRate= std::stod(argv[++i]);
+        else if(arg == "--lambda" && hasValue) options.lambda= std::stod(argv[++i]);
+        else if(arg == "--threads" && hasValue) options.threads= std::stoi(argv[++i]);
+        else if(arg == "--limit" && hasValue) options.limit= std::stoull(argv[++i]);
+        else if(options.dataPath.empty() && arg[0] != '-') options.dataPath= arg;
+        else {
+            std::cerr << "usage: talawachess tune DATA [--out HEADER] [--epochs N] [--lr X] [--lambda L] [--threads N] [--limit N]" << std::endl;
+            return 1;
+        }
+    }
+    if(options.dataPath.empty()) {
+        std::cerr << "tune: no data file given" << std::endl;
+        return 1;
+    }
+    talawachess::Tuner tuner(options);
+    return tuner.run();
+}
+
+// talawachess annotate GAMES.pgn [--out FILE] [--nodes N] [--threads N] [--mistake CP] [--blunder CP] [--hash MB]
+static int runAnnotate(int argc, char* argv[]) {
+    talawachess::AnnotateOptions options;
+    for(int i= 2; i < argc; ++i) {
+        std::string arg= argv[i];
+        bool hasValue= i + 1 < argc;
+        if(arg == "--out" && hasValue) options.outputPath= argv[++i];
+        else if(arg == "--nodes" && hasValue) options.nodes= std::stoull(argv[++i]);
+        else if(arg == "--threads" && hasValue) options.threads= std::stoi(argv[++i]);
+        else if(arg == "--mistake" && hasValue) options.mistakeCp= std::stoi(argv[++i]);
+        else if(arg == "--blunder" && hasValue) options.blunderCp= std::stoi(argv[++i]);
+        else if(arg == "--hash" && hasValue) options.hashMB= std::stoul(argv[++i]);
+        else if(options.inputPath.empty() && arg[0] != '-') options.inputPath= arg;
+        else {
+            std::cerr << "usage: talawachess annotate GAMES.pgn [--out FILE] [--nodes N] [--threads N] [--mistake CP] [--blunder CP] [--hash MB]" << std::endl;
+            return 1;
+        }
+    }
+    if(options.inputPath.empty()) {
+        std::cerr << "annotate: no PGN file given" << std::endl;
+        return 1;
+    }
+    talawachess::Annotator annotator(options);
+    return annotator.run();
+}
+
+// talawachess bench|profile [depth] [threads] [hash]
+static int runBench(int argc, char* argv[]) {
+    talawachess::BenchOptions options;
+    if(argc > 2) options.depth= std::stoi(argv[2]);
+    if(argc > 3) options.threads= std::stoi(argv[3]);
+    if(argc > 4) options.hashMB= std::stoul(argv[4]);
+    if(std::string(argv[1]) == "profile") talawachess::runProfile(options);
+    else talawachess::runBench(options);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    // Without arguments we are a UCI engine; a first argument selects a tool mode
+    if(argc > 1 && std::string(argv[1]) == "serve") {
+        return runServer(argc, argv);
+    }
+    if(argc > 1 && std::string(argv[1]) == "epd") {
+        return runEpd(argc, argv);
+    }
+    if(argc > 1 && std::string(argv[1]) == "selfplay") {
+        return runSelfPlay(argc, argv);
+    }
+    if(argc > 1 && std::string(argv[1]) == "datagen") {
+        return runDataGen(argc, argv);
+    }
+    if(argc > 1 && std::string(argv[1]) == "datainfo") {
+        return runDataInfo(argc, argv);
+    }
+    if(argc > 1 && std::string(argv[1]) == "tune") {
+        return runTune(argc, argv);
+    }
+    if(argc > 1 && std::string(argv[1]) == "annotate") {
+        return runAnnotate(argc, argv);
+    }
+    if(argc > 1 && (std::string(argv[1]) == "bench" || std::string(argv[1]) == "profile")) {
+        return runBench(argc, argv);
+    }
 
     talawachess::UCI uci;
     uci.listen(); // Start listening for GUI commands
@@ -0,0 +1,191 @@
+// talawachess_trace: queries a search trace written by a TALAWA_TRACE build (TraceFile option).
+//
+// Usage: talawachess_trace FILE                       searches in the file
+//        talawachess_trace FILE --search N            iterations of search N (1-based, default last)
+//        talawachess_trace FILE [--search N] --iteration D [--move M1[,M2...]] [--levels L]
+//            root moves of iteration D, or the subtree under the line M1 M2 ... (L levels, default 2)
+//
+// Records are written when a node returns, so every node is preceded by its subtree: walking
+// the records with a stack of finished nodes, a node at ply P adopts the finished nodes with a
+// ply above P, and the singular verification search run at its own ply.
+// Windows and scores are from the point of view of the side to move at the node.
+#include "SearchTrace.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace talawachess;
+
+// Bot's infinity and mate scores
+static const int INF= 1000000000;
+static const int MATE_VAL= 9000000;
+
+struct Node {
+    const trace::Record* record;
+    std::vector<int> children; // Search order
+    uint64_t size= 1;          // Records in the subtree, this one included
+};
+
+static std::string scoreToString(int score) {
+    if(score >= INF) return "inf";
+    if(score <= -INF) return "-inf";
+    if(score > MATE_VAL - 100) return "mate+" + std::to_string(MATE_VAL - score);
+    if(score < -MATE_VAL + 100) return "mate-" + std::to_string(MATE_VAL + score);
+    return std::to_string(score);
+}
+
+static std::string describe(const Node& node) {
+    const trace::Record& r= *node.record;
+    std::ostringstream line;
+    line << std::left << std::setw(6) << trace::moveToString(r.move) << std::right << " d=" << static_cast<int>(r.depth);
+    if(r.reduction != 0) line << " r=" << static_cast<int>(r.reduction);
+    if(r.extension != 0) line << " e=" << static_cast<int>(r.extension);
+    line << " [" << scoreToString(r.alpha) << "," << scoreToString(r.beta) << "] -> " << scoreToString(r.score) << " "
+         << trace::reasonName(static_cast<trace::Reason>(r.reason));
+    if(r.flags & trace::FLAG_VERIFICATION) line << " (singular verification)";
+    if(node.size > 1) line << " nodes=" << node.size;
+    line << " hash=" << std::hex << std::setw(16) << std::setfill('0') << r.hash;
+    return line.str();
+}
+
+static void printTree(const std::vector<Node>& nodes, int index, int indent, int levels) {
+    std::cout << std::string(indent * 2, ' ') << describe(nodes[index]) << "\n";
+    if(levels <= 1) return;
+    for(int child: nodes[index].children) printTree(nodes, child, indent + 1, levels - 1);
+}
+
+// Rebuilds the tree of records [begin, end) and returns the top-level nodes (root moves) in search order
+static std::vector<int> buildTree(const std::vector<trace::Record>& records, size_t begin, size_t end, std::vector<Node>& nodes) {
+    std::vector<int> finished;
+    for(size_t i= begin; i < end; ++i) {
+        Node node;
+        node.record= &records[i];
+        int ply= records[i].ply;
+        bool verification= records[i].flags & trace::FLAG_VERIFICATION;
+        while(!finished.empty()) {
+            const trace::Record& top= *nodes[finished.back()].record;
+            bool child= top.ply > ply || (!verification && top.ply == ply && (top.flags & trace::FLAG_VERIFICATION));
+            if(!child) break;
+            node.children.push_back(finished.back());
+            node.size+= nodes[finished.back()].size;
+            finished.pop_back();
+        }
+        std::reverse(node.children.begin(), node.children.end());
+        nodes.push_back(std::move(node));
+        finished.push_back(static_cast<int>(nodes.size()) - 1);
+    }
+    return finished;
+}
+
+static int usage() {
+    std::cerr << "usage: talawachess_trace FILE [--search N] [--iteration D] [--move M1[,M2...]] [--levels L]" << std::endl;
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    if(argc < 2) return usage();
+    std::string path= argv[1];
+    int searchNumber= 0, iteration= 0, levels= 2;
+    std::vector<std::string> line;
+    for(int i= 2; i < argc; ++i) {
+        std::string arg= argv[i];
+        if(i + 1 >= argc) return usage();
+        if(arg == "--search") searchNumber= std::atoi(argv[++i]);
+        else if(arg == "--iteration") iteration= std::atoi(argv[++i]);
+        else if(arg == "--levels") levels= std::max(1, std::atoi(argv[++i]));
+        else if(arg == "--move") {
+            std::stringstream moves(argv[++i]);
+            std::string move;
+            while(std::getline(moves, move, ',')) line.push_back(move);
+        } else {
+            return usage();
+        }
+    }
+
+    std::vector<trace::Record> records;
+    std::string error;
+    if(!trace::readFile(path, records, error)) {
+        std::cerr << "talawachess_trace: " << error << std::endl;
+        return 1;
+    }
+
+    // Searches start at their SEARCH_START marker
+    std::vector<size_t> starts;
+    for(size_t i= 0; i < records.size(); ++i) {
+        if(records[i].reason == trace::SEARCH_START) starts.push_back(i);
+    }
+    if(starts.empty()) {
+        std::cerr << "talawachess_trace: " << path << " holds no search" << std::endl;
+        return 1;
+    }
+    auto searchEnd= [&](size_t s) { return s + 1 < starts.size() ? starts[s + 1] : records.size(); };
+
+    if(searchNumber == 0 && iteration == 0) {
+        for(size_t s= 0; s < starts.size(); ++s) {
+            const trace::Record& start= records[starts[s]];
+            int lastIteration= 0;
+            for(size_t i= starts[s] + 1; i < searchEnd(s); ++i) lastIteration= std::max<int>(lastIteration, records[i].iteration);
+            std::cout << "search " << s + 1 << ": hash " << std::hex << std::setw(16) << std::setfill('0') << start.hash << std::dec
+                      << std::setfill(' ') << ", depth limit " << static_cast<int>(start.depth) << ", " << searchEnd(s) - starts[s] - 1
+                      << " nodes, " << lastIteration << " iterations\n";
+        }
+        return 0;
+    }
+
+    if(searchNumber == 0) searchNumber= static_cast<int>(starts.size());
+    if(searchNumber < 1 || searchNumber > static_cast<int>(starts.size())) {
+        std::cerr << "talawachess_trace: no search " << searchNumber << " (the file has " << starts.size() << ")" << std::endl;
+        return 1;
+    }
+    size_t begin= starts[searchNumber - 1] + 1, end= searchEnd(searchNumber - 1);
+
+    if(iteration == 0) {
+        std::vector<uint64_t> counts;
+        for(size_t i= begin; i < end; ++i) {
+            if(records[i].iteration >= counts.size()) counts.resize(records[i].iteration + 1);
+            counts[records[i].iteration]++;
+        }
+        for(size_t d= 1; d < counts.size(); ++d) std::cout << "iteration " << d << ": " << counts[d] << " nodes\n";
+        return 0;
+    }
+
+    // Records of one iteration are contiguous
+    while(begin < end && records[begin].iteration != iteration) begin++;
+    size_t iterationEnd= begin;
+    while(iterationEnd < end && records[iterationEnd].iteration == iteration) iterationEnd++;
+    if(begin == iterationEnd) {
+        std::cerr << "talawachess_trace: search " << searchNumber << " has no iteration " << iteration << std::endl;
+        return 1;
+    }
+
+    std::vector<Node> nodes;
+    nodes.reserve(iterationEnd - begin);
+    std::vector<int> level= buildTree(records, begin, iterationEnd, nodes);
+    int target= -1;
+    for(const auto& move: line) {
+        target= -1;
+        for(int index: level) {
+            // The last visit wins: an LMR re-search follows its reduced search
+            if(trace::moveToString(nodes[index].record->move) == move && !(nodes[index].record->flags & trace::FLAG_VERIFICATION)) {
+                target= index;
+            }
+        }
+        if(target < 0) {
+            std::cerr << "talawachess_trace: " << move << " was not searched there" << std::endl;
+            return 1;
+        }
+        level= nodes[target].children;
+    }
+
+    if(target < 0) {
+        std::cout << "iteration " << iteration << ", root moves:\n";
+        for(int index: level) printTree(nodes, index, 1, levels);
+    } else {
+        printTree(nodes, target, 0, levels + 1);
+    }
+    return 0;
+}